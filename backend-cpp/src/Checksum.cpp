@@ -0,0 +1,20 @@
+#include "Checksum.h"
+#include <openssl/evp.h>
+#include <cstdio>
+
+std::string md5Hex(const char* data, size_t size) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    if (EVP_Digest(data, size, digest, &digest_size, EVP_md5(), nullptr) != 1) {
+        return "";
+    }
+
+    std::string hex;
+    hex.reserve(digest_size * 2);
+    char buf[3];
+    for (unsigned int i = 0; i < digest_size; ++i) {
+        std::snprintf(buf, sizeof(buf), "%02x", digest[i]);
+        hex += buf;
+    }
+    return hex;
+}
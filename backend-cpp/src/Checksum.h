@@ -0,0 +1,11 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <string>
+#include <cstddef>
+
+// MD5 у hex (нижній регістр) - збігається з ETag R2 для звичайного PUT,
+// тому використовується як хеш вмісту оригіналу
+std::string md5Hex(const char* data, size_t size);
+
+#endif
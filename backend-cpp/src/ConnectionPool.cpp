@@ -0,0 +1,54 @@
+#include "ConnectionPool.h"
+#include <algorithm>
+#include <iostream>
+
+ConnectionPool::ConnectionPool(const std::string& connection_string, size_t size)
+    : connection_string(connection_string), size(std::max<size_t>(1, size)), created(0) {
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool && connection) {
+        pool->release(std::move(connection));
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    Lease lease;
+    lease.pool = this;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this]() { return !idle.empty() || created < size; });
+        if (!idle.empty()) {
+            lease.connection = std::move(idle.back());
+            idle.pop_back();
+            if (lease.connection->is_open()) {
+                return lease;
+            }
+            // Розірване з'єднання замінюємо новим на тому ж місці в пулі
+            lease.connection.reset();
+        } else {
+            ++created;
+        }
+    }
+
+    try {
+        lease.connection = std::make_unique<pqxx::connection>(connection_string);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        --created;
+        available.notify_one();
+        throw;
+    }
+    return lease;
+}
+
+void ConnectionPool::release(std::unique_ptr<pqxx::connection> connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (connection->is_open()) {
+        idle.push_back(std::move(connection));
+    } else {
+        std::cerr << "З'єднання з базою даних розірване, буде відкрите нове" << std::endl;
+        --created;
+    }
+    available.notify_one();
+}
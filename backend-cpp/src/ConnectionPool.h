@@ -0,0 +1,49 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <pqxx/pqxx>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Пул з'єднань до primary. З'єднання pqxx не потокобезпечне, тож кожен запит
+// бере окреме з'єднання на час транзакції. З'єднання створюються за потребою
+// до size штук; якщо всі зайняті, acquire() чекає на звільнене
+class ConnectionPool {
+private:
+    std::string connection_string;
+    size_t size;
+    size_t created;
+    std::vector<std::unique_ptr<pqxx::connection>> idle;
+    std::mutex mutex;
+    std::condition_variable available;
+
+    void release(std::unique_ptr<pqxx::connection> connection);
+
+public:
+    // З'єднання, видане на час запиту; повертається в пул у деструкторі
+    class Lease {
+    private:
+        ConnectionPool* pool = nullptr;
+        std::unique_ptr<pqxx::connection> connection;
+        friend class ConnectionPool;
+
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&& other) noexcept = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() const { return *connection; }
+    };
+
+    ConnectionPool(const std::string& connection_string, size_t size);
+
+    // Кидає виняток, якщо нове з'єднання не вдалося відкрити
+    Lease acquire();
+    size_t capacity() const { return size; }
+};
+
+#endif
@@ -1,19 +1,48 @@
 #include "DatabaseManager.h"
+#include "MigrationManager.h"
+#include "IdList.h"
 #include <iostream>
 #include <sstream>
 #include <exception>
 
+thread_local std::string DatabaseManager::current_client;
+
 DatabaseManager::DatabaseManager(const DatabaseConfig& db_config) 
     : config(db_config) {
 }
 
+DatabaseManager::ClientScope::ClientScope(const std::string& client)
+    : previous(std::move(current_client)) {
+    current_client = client;
+}
+
+DatabaseManager::ClientScope::~ClientScope() {
+    current_client = std::move(previous);
+}
+
+std::string DatabaseManager::ClientScope::release() {
+    std::string client = std::move(current_client);
+    current_client.clear();
+    return client;
+}
+
 // Підключення до бази даних
 bool DatabaseManager::connect() {
     try {
-        connection = std::make_unique<pqxx::connection>(config.getConnectionString());
-        if (connection->is_open()) {
-            std::cout << "Підключено до PostgreSQL бази даних: " << config.name << std::endl;
-            createTables();
+        primary = std::make_unique<ConnectionPool>(config.getConnectionString(), config.pool_size);
+        auto lease = primary->acquire();
+        if ((*lease).is_open()) {
+            std::cout << "Підключено до PostgreSQL бази даних: " << config.name
+                      << " (пул до " << primary->capacity() << " з'єднань)" << std::endl;
+            // Застосування відсутніх міграцій схеми
+            MigrationManager migrations(*lease);
+            if (!migrations.migrate()) {
+                return false;
+            }
+            if (!config.replica_hosts.empty()) {
+                replicas = std::make_unique<ReplicaPool>(config);
+                replicas->start();
+            }
             return true;
         } else {
             std::cerr << "Не вдалося підключитися до бази даних" << std::endl;
@@ -27,59 +56,45 @@ bool DatabaseManager::connect() {
 
 // Перевірка підключення до бази даних
 bool DatabaseManager::isConnected() const {
-    return connection && connection->is_open();
+    return primary != nullptr;
 }
 
-// Ініціалізація таблиць
-void DatabaseManager::createTables() {
-    try {
-        pqxx::work txn(*connection);
-        
-        std::string createTableSQL = R"(
-            CREATE TABLE IF NOT EXISTS images (
-                id SERIAL PRIMARY KEY,
-                name VARCHAR(255) , 
-                description TEXT , 
-                filename VARCHAR(255) NOT NULL,
-                original_path TEXT,
-                processed_path TEXT ,
-                status VARCHAR(50) DEFAULT 'pending',
-                error_message TEXT DEFAULT '',
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-            );
-            
-            CREATE INDEX IF NOT EXISTS idx_images_name  ON images(name);
-            CREATE INDEX IF NOT EXISTS idx_images_description  ON images(description);
-            CREATE INDEX IF NOT EXISTS idx_images_status ON images(status);
-            CREATE INDEX IF NOT EXISTS idx_images_created_at ON images(created_at);
-
-            CREATE TABLE IF NOT EXISTS tasks (
-                id SERIAL PRIMARY KEY,
-                processing_type VARCHAR(255) NOT NULL,
-                status VARCHAR(255) NOT NULL DEFAULT 'pending',
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-                completed_at TIMESTAMP NULL,
-                duration INTERVAL NULL,
-                image_id INT NOT NULL,
-                CONSTRAINT fk_image FOREIGN KEY (image_id)
-                REFERENCES images(id) ON DELETE CASCADE
-            );
-
-            CREATE INDEX IF NOT EXISTS idx_tasks_image_id ON tasks(image_id);
-            CREATE INDEX IF NOT EXISTS idx_tasks_status ON tasks(status);
-            CREATE INDEX IF NOT EXISTS idx_tasks_created_at ON tasks(created_at);
-            
-        )";
-        
-        txn.exec(createTableSQL);
-        txn.commit();
-        
-        std::cout << "Таблиці бази даних успішно створені/перевірені" << std::endl;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Помилка створення таблиць: " << e.what() << std::endl;
+// Запам'ятовуємо запис клієнта: його наступні читання йдуть на primary,
+// доки репліки гарантовано не отримали зміни
+void DatabaseManager::noteWrite() {
+    if (!replicas || current_client.empty() || config.read_your_writes_ms <= 0) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(recent_writes_mutex);
+    recent_writes[current_client] = now;
+
+    if (recent_writes.size() > 4096) {
+        auto window = std::chrono::milliseconds(config.read_your_writes_ms);
+        for (auto it = recent_writes.begin(); it != recent_writes.end();) {
+            if (now - it->second > window) {
+                it = recent_writes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool DatabaseManager::readFromPrimary() {
+    if (current_client.empty() || config.read_your_writes_ms <= 0) {
+        return false;
     }
+    std::lock_guard<std::mutex> lock(recent_writes_mutex);
+    auto it = recent_writes.find(current_client);
+    if (it == recent_writes.end()) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() - it->second > std::chrono::milliseconds(config.read_your_writes_ms)) {
+        recent_writes.erase(it);
+        return false;
+    }
+    return true;
 }
 
 // ОПЕРАЦІЇ З ЗОБРАЖЕННЯМИ ---------
@@ -87,20 +102,24 @@ void DatabaseManager::createTables() {
 // Створення зображення
 int DatabaseManager::createImage(const Image& image) {
     try {
-        pqxx::work txn(*connection);
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
         
         std::string sql = R"(
-            INSERT INTO images (name , description, filename, original_path, processed_path, status)
-            VALUES ($1, $2, $3, $4, $5 , $6 )
+            INSERT INTO images (name , description, filename, original_path, processed_path, status,
+                                size_bytes, checksum)
+            VALUES ($1, $2, $3, $4, $5 , $6, NULLIF($7::BIGINT, 0), NULLIF($8, '') )
             RETURNING id
         )";
         
         pqxx::result result = txn.exec_params(
-            sql, image.name , image.description, image.filename, image.original_path, image.processed_path ,
-            image.status
+            sql, std::string(image.name), std::string(image.description), std::string(image.filename),
+            std::string(image.original_path), std::string(image.processed_path),
+            std::string(toString(image.status)), image.size_bytes, std::string(image.checksum)
         );
         
         txn.commit();
+        noteWrite();
         
         // Повернення ID
         if (!result.empty()) {
@@ -116,16 +135,14 @@ int DatabaseManager::createImage(const Image& image) {
 }
 
 // Отримання зображення за ID
-Image DatabaseManager::getImage(int id) {
+Image DatabaseManager::getImage(int id, StringArena& arena) {
     try {
-        pqxx::nontransaction txn(*connection);
-        
-        std::string sql = "SELECT * FROM images WHERE id = $1";
-        pqxx::result result = txn.exec_params(sql, id);
+        std::string sql = std::string("SELECT ") + Image::SELECT_COLUMNS + " FROM images WHERE id = $1";
+        pqxx::result result = readQuery(sql, id);
         
         if (!result.empty()) {
             Image image;
-            image.fromPgResult(result[0]);
+            image.fromPgResult(result[0], arena);
             return image;
         }
         
@@ -138,56 +155,76 @@ Image DatabaseManager::getImage(int id) {
 }
 
 // Отримання всіх зображень
-std::vector<Image> DatabaseManager::getAllImages() {
-    std::vector<Image> images;
+ImageList DatabaseManager::getAllImages() {
+    ImageList images;
     
     try {
-        pqxx::nontransaction txn(*connection);
+        std::string sql = std::string("SELECT ") + Image::SELECT_COLUMNS + " FROM images ORDER BY created_at DESC";
+        pqxx::result result = readQuery(sql);
         
-        std::string sql = "SELECT * FROM images ORDER BY created_at DESC";
-        pqxx::result result = txn.exec(sql);
-        
-        for (const auto& row : result) {
-            Image image;
-            image.fromPgResult(row);
-            images.push_back(image);
+        images.items.resize(result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            images.items[i].fromPgResult(result[i], images.arena);
         }
         
     } catch (const std::exception& e) {
         std::cerr << "Помилка отримання всіх зображень: " << e.what() << std::endl;
+        images.items.clear();
     }
     
     return images;
 }
 
-// Отримання зображень за статусом
-std::vector<Image> DatabaseManager::getImagesByStatus(const std::string& status) {
-    std::vector<Image> images;
+// Отримання зображень за списком ID
+ImageList DatabaseManager::getImagesByIds(const std::vector<int>& ids) {
+    ImageList images;
     
     try {
-        pqxx::nontransaction txn(*connection);
+        std::string sql = std::string("SELECT ") + Image::SELECT_COLUMNS +
+                          " FROM images WHERE id = ANY($1::int[]) ORDER BY created_at DESC";
+        pqxx::result result = readQuery(sql, toPgIntArray(ids));
         
-        std::string sql = "SELECT * FROM images WHERE status = $1 ORDER BY created_at DESC";
-        pqxx::result result = txn.exec_params(sql, status);
+        images.items.resize(result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            images.items[i].fromPgResult(result[i], images.arena);
+        }
         
-        for (const auto& row : result) {
-            Image image;
-            image.fromPgResult(row);
-            images.push_back(image);
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка отримання зображень за списком: " << e.what() << std::endl;
+        images.items.clear();
+    }
+    
+    return images;
+}
+
+// Отримання зображень за статусом
+ImageList DatabaseManager::getImagesByStatus(ImageStatus status) {
+    ImageList images;
+    
+    try {
+        std::string sql = std::string("SELECT ") + Image::SELECT_COLUMNS +
+                          " FROM images WHERE status = $1 ORDER BY created_at DESC";
+        pqxx::result result = readQuery(sql, std::string(toString(status)));
+        
+        images.items.resize(result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            images.items[i].fromPgResult(result[i], images.arena);
         }
         
     } catch (const std::exception& e) {
         std::cerr << "Помилка отримання зображень за статусом: " << e.what() << std::endl;
+        images.items.clear();
     }
     
     return images;
 }
 
 // Оновлення статусу зображення
-bool DatabaseManager::updateImageStatus(int id, const std::string& status, 
+bool DatabaseManager::updateImageStatus(int id, ImageStatus status, 
                                        const std::string& error_msg ) {
     try {
-        pqxx::work txn(*connection);
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
         
         std::string sql = R"(
             UPDATE images 
@@ -195,8 +232,9 @@ bool DatabaseManager::updateImageStatus(int id, const std::string& status,
             WHERE id = $3
         )";
         
-        txn.exec_params(sql, status,  error_msg, id);
+        txn.exec_params(sql, std::string(toString(status)),  error_msg, id);
         txn.commit();
+        noteWrite();
         
         return true;
         
@@ -206,26 +244,53 @@ bool DatabaseManager::updateImageStatus(int id, const std::string& status,
     }
 }
 
+// Збереження хешу вмісту, якщо він ще не відомий
+bool DatabaseManager::setImageChecksum(int id, const std::string& checksum) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        txn.exec_params(R"(
+            UPDATE images SET checksum = $1, updated_at = CURRENT_TIMESTAMP
+            WHERE id = $2 AND checksum IS NULL
+        )", checksum, id);
+        txn.commit();
+        noteWrite();
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка збереження контрольної суми: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 // ОПЕРАЦІЇ З ЗАВДАННЯМИ-----
 
 // Створення завдання
 int DatabaseManager::createTask(const Task& task) {
     try {
-        pqxx::work txn(*connection);
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
 
         // Виправлено: INSERT INTO tasks (не images)
         std::string sql = R"(
-            INSERT INTO tasks (processing_type, status, image_id)
-            VALUES ($1, $2, $3)
+            INSERT INTO tasks (processing_type, status, image_id, priority, trace_id, processed_path,
+                               output_options, started_at, completed_at, duration)
+            VALUES ($1, $2, $3, $4, NULLIF($5, ''), NULLIF($6, ''), $7,
+                    CASE WHEN $2::varchar = 'completed' THEN CURRENT_TIMESTAMP END,
+                    CASE WHEN $2::varchar = 'completed' THEN CURRENT_TIMESTAMP END,
+                    CASE WHEN $2::varchar = 'completed' THEN INTERVAL '0' END)
             RETURNING id
         )";
         
         // Виправлено: видалено зайву кому
         pqxx::result result = txn.exec_params(
-            sql, task.processing_type, task.status, task.image_id
+            sql, std::string(toString(task.processing_type)), std::string(toString(task.status)), task.image_id,
+            task.priority, task.trace_id, std::string(task.processed_path), std::string(task.output_options)
         );
         
         txn.commit();
+        noteWrite();
         
         // Повернення ID
         if (!result.empty()) {
@@ -240,25 +305,283 @@ int DatabaseManager::createTask(const Task& task) {
     }
 }
 
+// Пошук готового результату за хешем вмісту оригіналу
+std::string DatabaseManager::findCachedResult(int image_id, ProcessingType processing_type, const std::string& params) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::nontransaction txn(*lease);
+
+        std::string sql = R"(
+            SELECT r.processed_path
+            FROM images i
+            JOIN processing_results r ON r.content_hash = i.checksum
+            WHERE i.id = $1 AND r.processing_type = $2 AND r.params = $3
+        )";
+        pqxx::result result = txn.exec_params(sql, image_id, std::string(toString(processing_type)), params);
+
+        if (!result.empty()) {
+            return result[0][0].as<std::string>();
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка пошуку кешованого результату: " << e.what() << std::endl;
+    }
+    return "";
+}
+
 // Отримання завдань для зображення
-std::vector<Task> DatabaseManager::getTasks(const int image_id ) {
-    std::vector<Task> tasks;
+TaskList DatabaseManager::getTasks(const int image_id ) {
+    TaskList tasks;
     
     try {
-        pqxx::nontransaction txn(*connection);
-        
-        std::string sql = "SELECT * FROM tasks WHERE  image_id = $1";
-        pqxx::result result = txn.exec_params(sql , image_id);
-        
-        for (const auto& row : result) {
-            Task task;
-            task.fromPgResult(row);
-            tasks.push_back(task); 
+        // Завершені завдання старші за термін зберігання знаходяться в архіві
+        std::string sql = std::string("SELECT ") + Task::SELECT_COLUMNS + " FROM tasks WHERE image_id = $1"
+                          " UNION ALL SELECT " + Task::SELECT_COLUMNS + " FROM tasks_archive WHERE image_id = $1";
+        pqxx::result result = readQuery(sql, image_id);
+        
+        tasks.items.resize(result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            tasks.items[i].fromPgResult(result[i], tasks.arena);
         }
         
     } catch (const std::exception& e) {
         std::cerr << "Помилка отримання всіх завдань: " << e.what() << std::endl;
+        tasks.items.clear();
     }
     
     return tasks;
+}
+
+// Отримання завдань для списку зображень
+TaskList DatabaseManager::getTasksForImages(const std::vector<int>& image_ids) {
+    TaskList tasks;
+    
+    try {
+        std::string sql = std::string("SELECT ") + Task::SELECT_COLUMNS + " FROM tasks WHERE image_id = ANY($1::int[])"
+                          " UNION ALL SELECT " + Task::SELECT_COLUMNS + " FROM tasks_archive WHERE image_id = ANY($1::int[])"
+                          " ORDER BY image_id, created_at";
+        pqxx::result result = readQuery(sql, toPgIntArray(image_ids));
+        
+        tasks.items.resize(result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            tasks.items[i].fromPgResult(result[i], tasks.arena);
+        }
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка отримання завдань для списку зображень: " << e.what() << std::endl;
+        tasks.items.clear();
+    }
+    
+    return tasks;
+}
+
+// СЕСІЇ ЗАВАНТАЖЕННЯ ЧАСТИНАМИ-----
+
+// Створення сесії завантаження
+bool DatabaseManager::createUploadSession(const UploadSession& session) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        std::string sql = R"(
+            INSERT INTO upload_sessions (id, image_id, object_key, r2_upload_id, total_size, part_size)
+            VALUES ($1, $2, $3, $4, $5, $6)
+        )";
+
+        txn.exec_params(sql, session.id, session.image_id, session.object_key, session.r2_upload_id,
+                        session.total_size, session.part_size);
+        txn.commit();
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка створення сесії завантаження: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Отримання сесії завантаження за ID
+UploadSession DatabaseManager::getUploadSession(const std::string& id) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::nontransaction txn(*lease);
+
+        std::string sql = std::string("SELECT ") + UploadSession::SELECT_COLUMNS +
+                          " FROM upload_sessions WHERE id = $1";
+        pqxx::result result = txn.exec_params(sql, id);
+
+        if (!result.empty()) {
+            UploadSession session;
+            session.fromPgResult(result[0]);
+            return session;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка отримання сесії завантаження: " << e.what() << std::endl;
+    }
+    return UploadSession();
+}
+
+// Утримання зміщення: з паралельних запитів на те саме зміщення лише один
+// завантажує частину в R2. Прострочене утримання (збій процесу) перехоплюється
+bool DatabaseManager::claimUploadOffset(const std::string& session_id, long long offset, const std::string& token,
+                                        int claim_seconds) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        pqxx::result updated = txn.exec_params(R"(
+            UPDATE upload_sessions
+            SET claim_token = $1,
+                claim_expires_at = CURRENT_TIMESTAMP + make_interval(secs => $2),
+                updated_at = CURRENT_TIMESTAMP
+            WHERE id = $3 AND upload_offset = $4 AND status = 'active'
+              AND (claim_token IS NULL OR claim_expires_at < CURRENT_TIMESTAMP)
+        )", token, claim_seconds, session_id, offset);
+
+        txn.commit();
+        return updated.affected_rows() > 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка утримання зміщення завантаження: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Зняття утримання після невдалого завантаження частини
+void DatabaseManager::releaseUploadClaim(const std::string& session_id, const std::string& token) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        txn.exec_params(R"(
+            UPDATE upload_sessions
+            SET claim_token = NULL, claim_expires_at = NULL
+            WHERE id = $1 AND claim_token = $2
+        )", session_id, token);
+        txn.commit();
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка зняття утримання зміщення: " << e.what() << std::endl;
+    }
+}
+
+// Запис частини та зсув зміщення в одній транзакції
+bool DatabaseManager::recordUploadPart(const std::string& session_id, const std::string& token, int part_number,
+                                       const std::string& etag, long long size, long long expected_offset,
+                                       long long new_offset) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        // Лише власник утримання; якщо воно прострочилося і перехоплене, запис відхиляється
+        pqxx::result updated = txn.exec_params(R"(
+            UPDATE upload_sessions
+            SET upload_offset = $1, claim_token = NULL, claim_expires_at = NULL, updated_at = CURRENT_TIMESTAMP
+            WHERE id = $2 AND upload_offset = $3 AND claim_token = $4 AND status = 'active'
+        )", new_offset, session_id, expected_offset, token);
+
+        if (updated.affected_rows() == 0) {
+            return false;
+        }
+
+        txn.exec_params(R"(
+            INSERT INTO upload_parts (session_id, part_number, etag, size)
+            VALUES ($1, $2, $3, $4)
+            ON CONFLICT (session_id, part_number) DO UPDATE SET etag = EXCLUDED.etag, size = EXCLUDED.size
+        )", session_id, part_number, etag, size);
+
+        txn.commit();
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка запису частини завантаження: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Частини сесії у порядку номерів
+std::vector<std::pair<int, std::string>> DatabaseManager::getUploadParts(const std::string& session_id) {
+    std::vector<std::pair<int, std::string>> parts;
+
+    try {
+        auto lease = primary->acquire();
+        pqxx::nontransaction txn(*lease);
+
+        pqxx::result result = txn.exec_params(
+            "SELECT part_number, etag FROM upload_parts WHERE session_id = $1 ORDER BY part_number",
+            session_id);
+
+        parts.reserve(result.size());
+        for (const auto& row : result) {
+            parts.emplace_back(row[0].as<int>(), row[1].as<std::string>());
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка отримання частин завантаження: " << e.what() << std::endl;
+        parts.clear();
+    }
+
+    return parts;
+}
+
+// Перехід статусу сесії лише з очікуваного стану, як і утримання зміщення:
+// завершення, скасування та прибирання покинутих сесій не перезаписують одне одного
+bool DatabaseManager::transitionUploadSession(const std::string& id, const std::string& from, const std::string& to) {
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        pqxx::result updated = txn.exec_params(R"(
+            UPDATE upload_sessions
+            SET status = $1, claim_token = NULL, claim_expires_at = NULL, updated_at = CURRENT_TIMESTAMP
+            WHERE id = $2 AND status = $3
+              AND (claim_token IS NULL OR claim_expires_at < CURRENT_TIMESTAMP)
+        )", to, id, from);
+        txn.commit();
+        return updated.affected_rows() > 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка оновлення статусу сесії завантаження: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Покинуті сесії. Перехід статусу і вибір в одному запиті, тож кожну сесію
+// отримує лише один екземпляр сервера
+std::vector<UploadSession> DatabaseManager::expireUploadSessions(int ttl_seconds, int limit) {
+    std::vector<UploadSession> sessions;
+
+    try {
+        auto lease = primary->acquire();
+        pqxx::work txn(*lease);
+
+        std::string sql = std::string(R"(
+            UPDATE upload_sessions
+            SET status = 'aborted', claim_token = NULL, claim_expires_at = NULL, updated_at = CURRENT_TIMESTAMP
+            WHERE id IN (
+                SELECT id FROM upload_sessions
+                WHERE status IN ('active', 'completing')
+                  AND updated_at < CURRENT_TIMESTAMP - make_interval(secs => $1)
+                  AND (claim_token IS NULL OR claim_expires_at < CURRENT_TIMESTAMP)
+                ORDER BY updated_at
+                LIMIT $2
+                FOR UPDATE SKIP LOCKED
+            )
+            RETURNING )") + UploadSession::SELECT_COLUMNS;
+
+        pqxx::result result = txn.exec_params(sql, ttl_seconds, limit);
+        txn.commit();
+
+        sessions.reserve(result.size());
+        for (const auto& row : result) {
+            UploadSession session;
+            session.fromPgResult(row);
+            sessions.push_back(std::move(session));
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка пошуку покинутих сесій завантаження: " << e.what() << std::endl;
+        sessions.clear();
+    }
+    return sessions;
 }
\ No newline at end of file
@@ -5,24 +5,55 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <iostream>
+#include <chrono>
+#include <unordered_map>
+#include "ReplicaPool.h"
+#include "ConnectionPool.h"
 #include "models/Image.h"
 #include "models/Task.h"
+#include "models/UploadSession.h"
 #include "config/Config.h"
 
 
 // Клас для взаємодії з базою даних
 class DatabaseManager {
 private:
-    //унікальне посилання на стрічку підключення
-    std::unique_ptr<pqxx::connection> connection;
+    // Пул з'єднань до primary: одне з'єднання pqxx - один запит одночасно
+    std::unique_ptr<ConnectionPool> primary;
 
     DatabaseConfig config;
-    // Ініціалізує таблиці в базі даних
-    void createTables();
+
+    // Репліки для читання; без DB_REPLICA_HOSTS усе читається з primary
+    std::unique_ptr<ReplicaPool> replicas;
+
+    // Час останнього запису кожного клієнта (read-your-writes)
+    std::mutex recent_writes_mutex;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> recent_writes;
+    static thread_local std::string current_client;
+
+    void noteWrite();
+    bool readFromPrimary();
+    // Запит лише для читання: репліка, якщо вона придатна, інакше primary
+    template <typename... Args>
+    pqxx::result readQuery(const std::string& sql, const Args&... args);
     
 public:
     DatabaseManager(const DatabaseConfig& db_config);
-    
+
+    // Клієнт поточного запиту для прив'язки читань до primary після його записів
+    class ClientScope {
+    private:
+        std::string previous;
+    public:
+        explicit ClientScope(const std::string& client);
+        ~ClientScope();
+        // Забирає клієнта поточного потоку для передачі у виконавця разом із запитом
+        static std::string release();
+        ClientScope(const ClientScope&) = delete;
+        ClientScope& operator=(const ClientScope&) = delete;
+    };
     
 
     bool connect();
@@ -32,18 +63,68 @@ public:
 
     //Зоображення
     int createImage(const Image& image); 
-    Image getImage(int id);
-    std::vector<Image> getAllImages();
-    std::vector<Image> getImagesByStatus(const std::string& status); //delete
-    bool updateImageStatus(int id, const std::string& status,   //delete
+    // Рядкові поля зображення розміщуються в переданій арені
+    Image getImage(int id, StringArena& arena);
+    ImageList getAllImages();
+    // Зображення з переданими ID одним запитом (відсутні ID пропускаються)
+    ImageList getImagesByIds(const std::vector<int>& ids);
+    ImageList getImagesByStatus(ImageStatus status); //delete
+    bool updateImageStatus(int id, ImageStatus status,   //delete
                           const std::string& error_msg);
     bool deleteImage(int id);
+    bool setImageChecksum(int id, const std::string& checksum);
     
     //Таски
-    std::vector<Task> getTasks(const int image_id );
+    TaskList getTasks(const int image_id );
+    // Завдання для кількох зображень одним запитом, впорядковані за image_id
+    TaskList getTasksForImages(const std::vector<int>& image_ids);
     int createTask(const Task& task);
+    // Готовий результат для вмісту зображення та типу обробки, "" якщо немає
+    std::string findCachedResult(int image_id, ProcessingType processing_type, const std::string& params);
+
+    //Сесії завантаження частинами
+    bool createUploadSession(const UploadSession& session);
+    UploadSession getUploadSession(const std::string& id);
+    // Утримує зміщення offset за token на claim_seconds до завантаження частини в R2.
+    // false якщо зміщення вже інше, його утримує інший запит, або помилка бази
+    bool claimUploadOffset(const std::string& session_id, long long offset, const std::string& token,
+                           int claim_seconds);
+    void releaseUploadClaim(const std::string& session_id, const std::string& token);
+    // Записує частину і переводить зміщення з expected_offset на new_offset, знімаючи
+    // утримання token. false якщо утримання втрачено або помилка бази
+    bool recordUploadPart(const std::string& session_id, const std::string& token, int part_number,
+                          const std::string& etag, long long size, long long expected_offset, long long new_offset);
+    std::vector<std::pair<int, std::string>> getUploadParts(const std::string& session_id);
+    // Умовний перехід статусу from -> to; з "active" лише без живого утримання
+    // зміщення. false якщо статус уже інший (паралельний запит, скасування) або помилка бази
+    bool transitionUploadSession(const std::string& id, const std::string& from, const std::string& to);
+    // Переводить у "aborted" до limit активних (або завислих у "completing") сесій
+    // без змін довше за ttl_seconds і без частини в процесі завантаження,
+    // повертає їх для скасування в R2
+    std::vector<UploadSession> expireUploadSessions(int ttl_seconds, int limit);
     
 
 };
 
+template <typename... Args>
+pqxx::result DatabaseManager::readQuery(const std::string& sql, const Args&... args) {
+    if (replicas && !readFromPrimary()) {
+        if (auto lease = replicas->acquire()) {
+            try {
+                pqxx::nontransaction txn(*lease);
+                return txn.exec_params(sql, args...);
+            } catch (const pqxx::broken_connection& e) {
+                std::cerr << "Втрачено з'єднання з реплікою " << lease.host() << ": " << e.what() << std::endl;
+                replicas->markBroken(lease);
+            } catch (const pqxx::sql_error& e) {
+                // Напр. скасування через конфлікт з відновленням - повторюємо на primary
+                std::cerr << "Помилка запиту на репліці " << lease.host() << ": " << e.what() << std::endl;
+            }
+        }
+    }
+    auto lease = primary->acquire();
+    pqxx::nontransaction txn(*lease);
+    return txn.exec_params(sql, args...);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "IdList.h"
+#include <algorithm>
+#include <charconv>
+#include <unordered_set>
+
+bool parseIdList(const std::string& value, std::vector<int>& ids, std::string& error) {
+    ids.clear();
+    std::unordered_set<int> seen;
+
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) end = value.size();
+
+        size_t first = value.find_first_not_of(' ', start);
+        size_t last = value.find_last_not_of(' ', end == 0 ? 0 : end - 1);
+        if (first < end && last != std::string::npos && last >= first) {
+            int id = 0;
+            const char* begin = value.data() + first;
+            const char* finish = value.data() + last + 1;
+            auto [ptr, ec] = std::from_chars(begin, finish, id);
+            if (ec != std::errc() || ptr != finish || id <= 0) {
+                error = "Невірний ідентифікатор: " + std::string(begin, finish);
+                return false;
+            }
+            if (seen.insert(id).second) {
+                ids.push_back(id);
+            }
+        }
+        start = end + 1;
+    }
+
+    if (ids.empty()) {
+        error = "Список ідентифікаторів порожній";
+        return false;
+    }
+    if (ids.size() > MAX_BATCH_IDS) {
+        error = "Забагато ідентифікаторів (максимум " + std::to_string(MAX_BATCH_IDS) + ")";
+        return false;
+    }
+    return true;
+}
+
+std::string toPgIntArray(const std::vector<int>& ids) {
+    std::string result = "{";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) result += ',';
+        result += std::to_string(ids[i]);
+    }
+    result += '}';
+    return result;
+}
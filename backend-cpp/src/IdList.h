@@ -0,0 +1,17 @@
+#ifndef ID_LIST_H
+#define ID_LIST_H
+
+#include <string>
+#include <vector>
+
+// Максимальна кількість ідентифікаторів в одному пакетному запиті
+constexpr size_t MAX_BATCH_IDS = 500;
+
+// Розбір списку "1,2,3" з параметра запиту. Дублікати відкидаються, порядок
+// першої появи зберігається. false з повідомленням у error при невірному списку
+bool parseIdList(const std::string& value, std::vector<int>& ids, std::string& error);
+
+// Літерал масиву PostgreSQL "{1,2,3}" для параметра $1::int[]
+std::string toPgIntArray(const std::vector<int>& ids);
+
+#endif
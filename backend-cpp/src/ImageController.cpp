@@ -4,43 +4,64 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include "models/TimeFormat.h"
+#include "tracing/Tracer.h"
+#include "Checksum.h"
+#include "IdList.h"
+#include "MultipartView.h"
+#include "middleware/BodyLimit.h"
+#include <optional>
+
+namespace {
+
+// Відповідь на Range тримає байти в пам'яті, тож довший діапазон обрізається:
+// клієнт бачить фактичний кінець у Content-Range і запитує решту
+const unsigned long long MAX_RANGE_BYTES = 8ULL * 1024 * 1024;
 
-ImageController::ImageController(DatabaseManager& db, R2Manager& r2_manager)
-    : db_manager(db), r2_manager(r2_manager) {
+}
+
+ImageController::ImageController(DatabaseManager& db, R2Manager& r2_manager, SimilarityIndex& similarity_index)
+    : db_manager(db), r2_manager(r2_manager), similarity_index(similarity_index) {
 }
 
 crow::response ImageController::uploadImage(const crow::request& req) {
     std::cout << "=== Початок оброблення фото ===" << std::endl;
     try {
-        // Парсинг multipart form data
-        crow::multipart::message msg(req);
+        // Парсинг multipart form data без копіювання: великі тіла вже у
+        // тимчасовому файлі (BodyLimit), частини вказують у нього
+        std::string_view body = BodyLimit::body(req);
+        std::optional<tracing::Span> parse_span;
+        parse_span.emplace("multipart.parse");
+        parse_span->setAttribute("http.request.body.size", static_cast<int64_t>(body.size()));
+        MultipartView msg;
+        if (!msg.parse(req.get_header_value("Content-Type"), body)) {
+            return crow::response(400, "Невірний multipart запит");
+        }
         
         // Отримання назви з запиту
-        std::string name = msg.get_part_by_name("name").body;
+        std::string name = msg.field("name");
         std::cout << "   Назва: " << name << std::endl;
 
         // Отримання опису з запиту
-        std::string description = msg.get_part_by_name("description").body;
+        std::string description = msg.field("description");
         std::cout << "   Опис: " << description << std::endl;
 
         // Отримання бінарних даних файлу
-        auto file_part = msg.get_part_by_name("file");
-        auto content_disposition = file_part.get_header_object("Content-Disposition");
-        std::cout << "   Content-Disposition: " << content_disposition.value << std::endl;
+        const MultipartPart* file_part = msg.get("file");
         
         // Безпечне отримання імені файлу
         std::string filename;
-        auto it = content_disposition.params.find("filename");
-        if (it != content_disposition.params.end()) {
-            filename = it->second;
+        if (file_part && !file_part->filename.empty()) {
+            filename = std::string(file_part->filename);
             std::cout << "Ім'я файлу: " << filename << std::endl;
         } else {
             std::cout << "   ПОМИЛКА: Ім'я файлу не знайдено" << std::endl;
             return crow::response(400, "Ім'я файлу не надано");
         }
         
-        // Витягнення даних файлу
-        std::string file_data = file_part.body;
+        // Дані файлу (без копії)
+        std::string_view file_data = file_part->body;
+        parse_span.reset();
         
         // Перевірка формату зображення
         if (!isValidImageFormat(filename)) {
@@ -50,8 +71,19 @@ crow::response ImageController::uploadImage(const crow::request& req) {
 
         // Завантаження метаданих в базу даних
         std::cout << "Завантажуємо метадані в базу даних" << std::endl;
-        Image new_image(name, description, filename, "", "", "uploaded");
-        int image_id = db_manager.createImage(new_image);
+        Image new_image(name, description, filename, "", "", ImageStatus::Uploaded);
+        new_image.size_bytes = static_cast<long long>(file_data.size());
+        // Хеш вмісту - ключ кешу результатів обробки
+        std::string checksum = md5Hex(file_data.data(), file_data.size());
+        new_image.checksum = checksum;
+        int image_id;
+        {
+            tracing::Span db_span("db.createImage");
+            image_id = db_manager.createImage(new_image);
+            if (image_id == -1) {
+                db_span.setError();
+            }
+        }
         
         // Якщо функція createImage повертає -1, база даних не створила зображення
         if (image_id == -1) {
@@ -61,7 +93,11 @@ crow::response ImageController::uploadImage(const crow::request& req) {
 
         // Завантаження фото на віддалене сховище
         std::cout << "Завантажуємо фото на S3" << std::endl;
-        r2_manager.uploadImageToR2(filename, file_data ,image_id);
+        {
+            tracing::Span r2_span("r2.uploadImage");
+            r2_span.setAttribute("file.size", static_cast<int64_t>(file_data.size()));
+            r2_manager.uploadImageToR2(filename, file_data ,image_id);
+        }
         
         std::cout << "Фото збережене " << image_id << std::endl;
         
@@ -86,23 +122,150 @@ crow::response ImageController::uploadImage(const crow::request& req) {
     }
 }
 
+// Створення запису зображення та підписаного URL для прямого завантаження в R2.
+// Байти файлу не проходять через API сервер
+crow::response ImageController::createUploadUrl(const crow::request& req) {
+    try {
+        crow::multipart::message msg(req);
+
+        std::string name = msg.get_part_by_name("name").body;
+        std::string description = msg.get_part_by_name("description").body;
+        std::string filename = msg.get_part_by_name("filename").body;
+        std::string size_str = msg.get_part_by_name("size").body;
+        std::string checksum = msg.get_part_by_name("checksum").body;
+
+        if (filename.empty()) {
+            return crow::response(400, "Ім'я файлу не надано");
+        }
+        if (!isValidImageFormat(filename)) {
+            return crow::response(400, "Невірний формат зображення");
+        }
+
+        // Очікуваний розмір обов'язковий - по ньому перевіряється завантаження
+        long long size_bytes = 0;
+        try {
+            size_bytes = std::stoll(size_str);
+        } catch (const std::exception&) {
+            return crow::response(400, "Невірний розмір файлу");
+        }
+        if (size_bytes <= 0) {
+            return crow::response(400, "Невірний розмір файлу");
+        }
+
+        // Контрольна сума (MD5 hex) необов'язкова
+        std::transform(checksum.begin(), checksum.end(), checksum.begin(), ::tolower);
+        if (!checksum.empty() && (checksum.size() != 32 ||
+            checksum.find_first_not_of("0123456789abcdef") != std::string::npos)) {
+            return crow::response(400, "Невірна контрольна сума");
+        }
+
+        Image new_image(name, description, filename, "", "", ImageStatus::AwaitingUpload);
+        new_image.size_bytes = size_bytes;
+        new_image.checksum = checksum;
+        int image_id;
+        {
+            tracing::Span db_span("db.createImage");
+            image_id = db_manager.createImage(new_image);
+        }
+        if (image_id == -1) {
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        std::string key = r2_manager.getOriginalKey(filename, image_id);
+        std::string upload_url;
+        {
+            tracing::Span presign_span("r2.presignPut");
+            upload_url = r2_manager.generatePresignedPutURL(key);
+        }
+        if (upload_url.empty()) {
+            db_manager.updateImageStatus(image_id, ImageStatus::Error, "Не вдалося створити URL завантаження");
+            return crow::response(500, "Помилка створення URL завантаження");
+        }
+
+        crow::json::wvalue response;
+        response["id"] = image_id;
+        response["upload_url"] = upload_url;
+        response["method"] = "PUT";
+        response["key"] = key;
+        response["expires_in"] = r2_manager.getPresignExpirySeconds();
+        response["status"] = "awaiting_upload";
+        return crow::response(201, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Підтвердження прямого завантаження: HEAD запит до R2, перевірка розміру та контрольної суми
+crow::response ImageController::completeUpload(const crow::request& req, int id) {
+    try {
+        StringArena arena;
+        Image image = db_manager.getImage(id, arena);
+        if (image.id == -1) {
+            return crow::response(404, "Зображення не знайдено");
+        }
+
+        crow::json::wvalue response;
+        response["id"] = image.id;
+        response["url"] = r2_manager.getPublicURL(image.filename, image.id);
+
+        // Повторний виклик для вже підтвердженого завантаження
+        if (image.status != ImageStatus::AwaitingUpload) {
+            if (image.status == ImageStatus::Error) {
+                return crow::response(409, "Завантаження відхилене: " + std::string(image.error_message));
+            }
+            response["status"] = std::string(toString(image.status));
+            return crow::response(200, response);
+        }
+
+        R2ObjectInfo info;
+        {
+            tracing::Span head_span("r2.headObject");
+            info = r2_manager.headObject(r2_manager.getOriginalKey(image.filename, image.id));
+        }
+        if (!info.exists) {
+            return crow::response(409, "Файл ще не завантажено");
+        }
+
+        if (info.size != image.size_bytes) {
+            db_manager.updateImageStatus(id, ImageStatus::Error, "Розмір файлу не збігається");
+            return crow::response(422, "Розмір файлу не збігається");
+        }
+
+        if (!image.checksum.empty() && info.etag != image.checksum) {
+            db_manager.updateImageStatus(id, ImageStatus::Error, "Контрольна сума не збігається");
+            return crow::response(422, "Контрольна сума не збігається");
+        }
+
+        if (!db_manager.updateImageStatus(id, ImageStatus::Uploaded, "")) {
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        // Без контрольної суми від клієнта хешем вмісту стає ETag звичайного PUT (MD5)
+        if (image.checksum.empty() && info.etag.size() == 32 &&
+            info.etag.find_first_not_of("0123456789abcdef") == std::string::npos) {
+            db_manager.setImageChecksum(id, info.etag);
+        }
+
+        response["status"] = "uploaded";
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
 crow::response ImageController::getAllImages(const crow::request& req) {
     try {
         // Використання менеджера бази даних для отримання зображень
         auto images = db_manager.getAllImages();
         crow::json::wvalue response;
         crow::json::wvalue::list images_list;
+        images_list.reserve(images.items.size());
         
-        for (const auto& image : images) {
-            // Конвертація кожного зображення в JSON
-            crow::json::wvalue img_json;
-            img_json["id"] = image.id;
-            img_json["name"] = image.name;
-            img_json["description"] = image.description;
-            img_json["filename"] = image.filename;
-            img_json["created_at"] = image.created_at;
-            // Додавання зображення до списку
-            images_list.push_back(img_json);
+        for (const auto& image : images.items) {
+            // Конвертація кожного зображення в JSON та додавання до списку
+            images_list.push_back(imageSummaryJson(image));
         }
         
         response["images"] = std::move(images_list);
@@ -116,6 +279,50 @@ crow::response ImageController::getAllImages(const crow::request& req) {
     }
 }
 
+crow::response ImageController::getImagesByIds(const crow::request& req) {
+    try {
+        const char* ids_param = req.url_params.get("ids");
+        if (!ids_param) {
+            return crow::response(400, "Параметр ids обов'язковий");
+        }
+
+        std::vector<int> ids;
+        std::string error;
+        if (!parseIdList(ids_param, ids, error)) {
+            return crow::response(400, error);
+        }
+
+        ImageList images;
+        {
+            tracing::Span db_span("db.getImagesByIds");
+            db_span.setAttribute("image_count", static_cast<int>(ids.size()));
+            images = db_manager.getImagesByIds(ids);
+        }
+
+        crow::json::wvalue response;
+        crow::json::wvalue::list images_list;
+        images_list.reserve(images.items.size());
+        for (const auto& image : images.items) {
+            images_list.push_back(imageSummaryJson(image));
+        }
+        response["images"] = std::move(images_list);
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+crow::json::wvalue ImageController::imageSummaryJson(const Image& image) {
+    crow::json::wvalue img_json;
+    img_json["id"] = image.id;
+    img_json["name"] = std::string(image.name);
+    img_json["description"] = std::string(image.description);
+    img_json["filename"] = std::string(image.filename);
+    img_json["created_at"] = formatTimestamp(image.created_at);
+    return img_json;
+}
+
 
 
 crow::response ImageController::getImagesByStatus(const crow::request& req, const std::string& status) {
@@ -124,19 +331,25 @@ crow::response ImageController::getImagesByStatus(const crow::request& req, cons
             return crow::response(400, "Параметр статусу обов'язковий");
         }
         
-        auto images = db_manager.getImagesByStatus(status);
+        ImageStatus image_status = imageStatusFromString(status);
+        if (image_status == ImageStatus::Unknown) {
+            return crow::response(400, "Невідомий статус");
+        }
+
+        auto images = db_manager.getImagesByStatus(image_status);
         crow::json::wvalue response;
         
-        response["count"] = images.size();
+        response["count"] = images.items.size();
         response["status"] = status;
         
         crow::json::wvalue::list images_list;
-        for (const auto& image : images) {
+        images_list.reserve(images.items.size());
+        for (const auto& image : images.items) {
             crow::json::wvalue img_json;
             img_json["id"] = image.id;
-            img_json["filename"] = image.filename;
-            img_json["status"] = image.status;
-            img_json["created_at"] = image.created_at;
+            img_json["filename"] = std::string(image.filename);
+            img_json["status"] = std::string(toString(image.status));
+            img_json["created_at"] = formatTimestamp(image.created_at);
             images_list.push_back(img_json);
         }
         
@@ -150,7 +363,8 @@ crow::response ImageController::getImagesByStatus(const crow::request& req, cons
 
 crow::response ImageController::getImageById(const crow::request& req, int id) {
     try {
-        Image image = db_manager.getImage(id); 
+        StringArena arena;
+        Image image = db_manager.getImage(id, arena); 
 
         if (image.id == -1) {
             return crow::response(404, "Зображення не знайдено");
@@ -158,11 +372,11 @@ crow::response ImageController::getImageById(const crow::request& req, int id) {
 
         crow::json::wvalue response;
         response["id"] = image.id;
-        response["name"] = image.name;
-        response["filename"] = image.filename;
-        response["status"] = image.status;
-        response["description"] = image.description;
-        response["created_at"] = image.created_at;
+        response["name"] = std::string(image.name);
+        response["filename"] = std::string(image.filename);
+        response["status"] = std::string(toString(image.status));
+        response["description"] = std::string(image.description);
+        response["created_at"] = formatTimestamp(image.created_at);
         
         return crow::response(200, response);
 
@@ -171,6 +385,178 @@ crow::response ImageController::getImageById(const crow::request& req, int id) {
     }
 }
 
+crow::response ImageController::getSimilarImages(const crow::request& req, int id) {
+    try {
+        if (!similarity_index.ready()) {
+            crow::response res(503, "Індекс схожих зображень ще завантажується");
+            res.set_header("Retry-After", "5");
+            return res;
+        }
+
+        int max_distance = similarity_index.defaultMaxDistance();
+        int limit = 50;
+        try {
+            if (const char* value = req.url_params.get("max_distance")) max_distance = std::stoi(value);
+            if (const char* value = req.url_params.get("limit")) limit = std::stoi(value);
+        } catch (const std::exception&) {
+            return crow::response(400, "Невірні параметри max_distance або limit");
+        }
+        if (max_distance < 0 || max_distance > MultiIndexHash::MAX_DISTANCE) {
+            return crow::response(400, "max_distance має бути від 0 до " + std::to_string(MultiIndexHash::MAX_DISTANCE));
+        }
+        if (limit < 1 || limit > 500) {
+            return crow::response(400, "limit має бути від 1 до 500");
+        }
+
+        uint64_t hash = 0;
+        if (!similarity_index.findHash(id, hash)) {
+            // Розрізняємо відсутнє зображення і ще не обчислений хеш
+            StringArena arena;
+            if (db_manager.getImage(id, arena).id == -1) {
+                return crow::response(404, "Зображення не знайдено");
+            }
+            return crow::response(404, "Перцептивний хеш зображення ще не обчислений");
+        }
+
+        std::vector<SimilarMatch> matches;
+        {
+            tracing::Span index_span("similarity.query");
+            index_span.setAttribute("max_distance", max_distance);
+            matches = similarity_index.findSimilar(hash, max_distance, static_cast<size_t>(limit), id);
+        }
+
+        crow::json::wvalue response;
+        response["image_id"] = id;
+        response["max_distance"] = max_distance;
+        crow::json::wvalue::list similar;
+        similar.reserve(matches.size());
+        for (const auto& match : matches) {
+            crow::json::wvalue item;
+            item["id"] = match.id;
+            item["distance"] = match.distance;
+            similar.push_back(std::move(item));
+        }
+        response["similar"] = std::move(similar);
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Віддача оригіналу зображення з локального кешу з підтримкою HTTP Range;
+// весь файл віддається потоково з диска, діапазон - обмеженим шматком
+crow::response ImageController::getImageContent(const crow::request& req, int id) {
+    try {
+        StringArena arena;
+        Image image = db_manager.getImage(id, arena);
+        if (image.id == -1) {
+            return crow::response(404, "Зображення не знайдено");
+        }
+        if (image.status == ImageStatus::AwaitingUpload || image.status == ImageStatus::Error) {
+            return crow::response(409, "Файл зображення недоступний");
+        }
+
+        ObjectCache::File file;
+        {
+            tracing::Span cache_span("r2.getObject");
+            file = r2_manager.getObject(r2_manager.getOriginalKey(image.filename, image.id));
+        }
+        if (!file.valid()) {
+            return crow::response(502, "Не вдалося отримати файл зі сховища");
+        }
+        unsigned long long size = file.size();
+
+        crow::response res;
+        std::string range = req.get_header_value("Range");
+        if (range.empty() || size == 0) {
+            // Увесь файл Crow віддає з диска частинами, не завантажуючи його в пам'ять.
+            // Файл відкривається вже після обробника - шлях живе RETIRE_DELAY після витіснення
+            res.set_static_file_info_unsafe(file.path(), getContentType(image.filename));
+            res.set_header("Accept-Ranges", "bytes");
+            res.set_header("Cache-Control", "public, max-age=86400");
+            return res;
+        }
+
+        res.set_header("Content-Type", getContentType(image.filename));
+        res.set_header("Accept-Ranges", "bytes");
+        res.set_header("Cache-Control", "public, max-age=86400");
+
+        unsigned long long start = 0;
+        unsigned long long end = 0;
+        if (!parseRange(range, size, start, end)) {
+            res.code = 416;
+            res.set_header("Content-Range", "bytes */" + std::to_string(size));
+            return res;
+        }
+        end = std::min(end, start + MAX_RANGE_BYTES - 1);
+
+        if (!file.readRange(start, end - start + 1, res.body)) {
+            return crow::response(500, "Помилка читання файлу");
+        }
+
+        res.code = 206;
+        res.set_header("Content-Range", "bytes " + std::to_string(start) + "-" +
+                       std::to_string(end) + "/" + std::to_string(size));
+        return res;
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+bool ImageController::parseRange(const std::string& header, unsigned long long size,
+                                 unsigned long long& start, unsigned long long& end) {
+    const std::string prefix = "bytes=";
+    if (header.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    std::string spec = header.substr(prefix.size());
+    // Кілька діапазонів не підтримуються
+    if (spec.find(',') != std::string::npos) {
+        return false;
+    }
+
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return false;
+    }
+    std::string first = spec.substr(0, dash);
+    std::string last = spec.substr(dash + 1);
+
+    try {
+        if (first.empty()) {
+            // bytes=-N: останні N байт
+            if (last.empty()) {
+                return false;
+            }
+            unsigned long long suffix = std::stoull(last);
+            if (suffix == 0) {
+                return false;
+            }
+            start = suffix >= size ? 0 : size - suffix;
+            end = size - 1;
+        } else {
+            start = std::stoull(first);
+            end = last.empty() ? size - 1 : std::min(std::stoull(last), size - 1);
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    return start <= end && start < size;
+}
+
+std::string ImageController::getContentType(std::string_view filename) {
+    std::string ext = std::filesystem::path(std::string(filename)).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
+    if (ext == ".png") return "image/png";
+    if (ext == ".gif") return "image/gif";
+    if (ext == ".bmp") return "image/bmp";
+    return "application/octet-stream";
+}
+
 bool ImageController::isValidImageFormat(const std::string& filename) {
     std::string allowed_ext[] = {".jpg", ".jpeg", ".png", ".gif", ".bmp"};
     std::string lower_filename = filename;
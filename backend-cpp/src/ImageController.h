@@ -4,6 +4,7 @@
 #include "crow.h"
 #include "DatabaseManager.h"
 #include "R2Manager.h"
+#include "similarity/SimilarityIndex.h"
 #include "models/Image.h"
 #include <string>
 
@@ -12,16 +13,30 @@ class ImageController {
 private:
     DatabaseManager& db_manager;
     R2Manager& r2_manager;
+    SimilarityIndex& similarity_index;
 
     
     std::string saveFile(const crow::request& req, const std::string& filename);
-    bool isValidImageFormat(const std::string& filename);
+    std::string getContentType(std::string_view filename);
+    // Розбір заголовка Range (лише один діапазон bytes=start-end)
+    bool parseRange(const std::string& header, unsigned long long size,
+                    unsigned long long& start, unsigned long long& end);
+    // Короткий опис зображення для списків
+    crow::json::wvalue imageSummaryJson(const Image& image);
     
 public:
-    ImageController(DatabaseManager& db , R2Manager& r2_manager );
+    ImageController(DatabaseManager& db , R2Manager& r2_manager, SimilarityIndex& similarity_index);
+    static bool isValidImageFormat(const std::string& filename);
     crow::response uploadImage(const crow::request& req);
+    crow::response createUploadUrl(const crow::request& req);
+    crow::response completeUpload(const crow::request& req, int id);
     crow::response getAllImages(const crow::request& req);
+    // GET /api/images?ids=1,2,3 - кілька зображень одним запитом
+    crow::response getImagesByIds(const crow::request& req);
     crow::response getImageById(const crow::request& req, int id);
+    crow::response getImageContent(const crow::request& req, int id);
+    // GET /api/images/<id>/similar?max_distance=&limit= - схожі за перцептивним хешем
+    crow::response getSimilarImages(const crow::request& req, int id);
     crow::response getImagesByStatus(const crow::request& req ,  const std::string& status);
     crow::response deleteImage(const crow::request& req, int id);
     
@@ -0,0 +1,423 @@
+#include "MigrationManager.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Ключ advisory lock, щоб кілька екземплярів не мігрували одночасно
+const long long MIGRATION_LOCK_KEY = 7240518300001;
+const std::chrono::seconds LOCK_RETRY_INTERVAL(1);
+
+// Ім'я індексу з "CREATE [UNIQUE] INDEX CONCURRENTLY [IF NOT EXISTS] name ON ...",
+// порожній рядок для інших інструкцій
+std::string concurrentIndexName(const std::string& statement) {
+    std::istringstream words(statement);
+    std::string word;
+    std::vector<std::string> tokens;
+    while (tokens.size() < 7 && words >> word) {
+        tokens.push_back(word);
+    }
+    size_t i = 0;
+    if (i < tokens.size() && tokens[i] == "CREATE") ++i; else return "";
+    if (i < tokens.size() && tokens[i] == "UNIQUE") ++i;
+    if (i < tokens.size() && tokens[i] == "INDEX") ++i; else return "";
+    if (i < tokens.size() && tokens[i] == "CONCURRENTLY") ++i; else return "";
+    if (i + 2 < tokens.size() && tokens[i] == "IF" && tokens[i + 1] == "NOT" && tokens[i + 2] == "EXISTS") i += 3;
+    return i < tokens.size() && tokens[i] != "ON" ? tokens[i] : "";
+}
+
+}
+
+MigrationManager::MigrationManager(pqxx::connection& conn)
+    : connection(conn) {
+}
+
+// Список міграцій. Нові кроки додаються лише в кінець зі зростаючою версією
+const std::vector<Migration>& MigrationManager::migrations() {
+    static const std::vector<Migration> list = {
+        {1, "create_tables", true, {
+            R"(
+            CREATE TABLE IF NOT EXISTS images (
+                id SERIAL PRIMARY KEY,
+                name VARCHAR(255) , 
+                description TEXT , 
+                filename VARCHAR(255) NOT NULL,
+                original_path TEXT,
+                processed_path TEXT ,
+                status VARCHAR(50) DEFAULT 'pending',
+                error_message TEXT DEFAULT '',
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+            )",
+            R"(
+            CREATE TABLE IF NOT EXISTS tasks (
+                id SERIAL PRIMARY KEY,
+                processing_type VARCHAR(255) NOT NULL,
+                status VARCHAR(255) NOT NULL DEFAULT 'pending',
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                completed_at TIMESTAMP NULL,
+                duration INTERVAL NULL,
+                image_id INT NOT NULL,
+                CONSTRAINT fk_image FOREIGN KEY (image_id)
+                REFERENCES images(id) ON DELETE CASCADE
+            )
+            )"
+        }},
+        // Індекси будуються без блокування запису в таблиці
+        {2, "create_indexes", false, {
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_images_name ON images(name)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_images_description ON images(description)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_images_status ON images(status)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_images_created_at ON images(created_at)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_tasks_image_id ON tasks(image_id)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_tasks_status ON tasks(status)",
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_tasks_created_at ON tasks(created_at)"
+        }},
+        {3, "images_size_and_checksum", true, {
+            "ALTER TABLE images ADD COLUMN IF NOT EXISTS size_bytes BIGINT",
+            "ALTER TABLE images ADD COLUMN IF NOT EXISTS checksum VARCHAR(64)"
+        }},
+        // Пріоритет завдання та час початку обробки для моделі вартості планувальника
+        {4, "tasks_priority_and_started_at", true, {
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS priority SMALLINT NOT NULL DEFAULT 0",
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS started_at TIMESTAMP NULL"
+        }},
+        // trace id запиту, що створив завдання, для продовження траси в обробнику
+        {5, "tasks_trace_id", true, {
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS trace_id VARCHAR(32)"
+        }},
+        // Сесії відновлюваних завантажень частинами
+        {6, "upload_sessions", true, {
+            R"(
+            CREATE TABLE IF NOT EXISTS upload_sessions (
+                id VARCHAR(32) PRIMARY KEY,
+                image_id INT NOT NULL,
+                object_key TEXT NOT NULL,
+                r2_upload_id TEXT NOT NULL,
+                total_size BIGINT NOT NULL,
+                part_size BIGINT NOT NULL,
+                upload_offset BIGINT NOT NULL DEFAULT 0,
+                status VARCHAR(32) NOT NULL DEFAULT 'active',
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                CONSTRAINT fk_upload_image FOREIGN KEY (image_id)
+                REFERENCES images(id) ON DELETE CASCADE
+            )
+            )",
+            R"(
+            CREATE TABLE IF NOT EXISTS upload_parts (
+                session_id VARCHAR(32) NOT NULL,
+                part_number INT NOT NULL,
+                etag TEXT NOT NULL,
+                size BIGINT NOT NULL,
+                PRIMARY KEY (session_id, part_number),
+                CONSTRAINT fk_upload_session FOREIGN KEY (session_id)
+                REFERENCES upload_sessions(id) ON DELETE CASCADE
+            )
+            )"
+        }},
+        // Кеш результатів обробки за хешем вмісту оригіналу
+        {7, "processing_results", true, {
+            R"(
+            CREATE TABLE IF NOT EXISTS processing_results (
+                content_hash VARCHAR(64) NOT NULL,
+                processing_type VARCHAR(255) NOT NULL,
+                params TEXT NOT NULL DEFAULT '',
+                processed_path TEXT NOT NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                PRIMARY KEY (content_hash, processing_type, params)
+            )
+            )",
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS processed_path TEXT"
+        }},
+        // Параметри кодування результату (канонічний рядок OutputOptions)
+        {8, "tasks_output_options", true, {
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS output_options TEXT NOT NULL DEFAULT ''"
+        }},
+        // tasks секціонується помісячно за created_at; завершені завдання переносить
+        // у tasks_archive TaskRetention. Гарячі запити йдуть по частковому індексу
+        // лише для pending/processing, тож не залежать від обсягу історії.
+        // Потребує вікна обслуговування: весь крок - одна транзакція, що тримає
+        // ACCESS EXCLUSIVE на tasks, копіює всю tasks_legacy і будує первинний ключ
+        // та індекси; тривалість пропорційна розміру tasks. Обробники й API мають
+        // бути зупинені, інакше lock_timeout (5s) зупинить старт сервера
+        {9, "partition_tasks", true, {
+            "ALTER TABLE tasks RENAME TO tasks_legacy",
+            R"(
+            CREATE TABLE tasks (
+                id INT NOT NULL DEFAULT nextval('tasks_id_seq'),
+                processing_type VARCHAR(255) NOT NULL,
+                status VARCHAR(255) NOT NULL DEFAULT 'pending',
+                created_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+                completed_at TIMESTAMP NULL,
+                duration INTERVAL NULL,
+                image_id INT NOT NULL,
+                priority SMALLINT NOT NULL DEFAULT 0,
+                started_at TIMESTAMP NULL,
+                trace_id VARCHAR(32),
+                processed_path TEXT,
+                output_options TEXT NOT NULL DEFAULT '',
+                CONSTRAINT fk_image FOREIGN KEY (image_id)
+                REFERENCES images(id) ON DELETE CASCADE
+            ) PARTITION BY RANGE (created_at)
+            )",
+            "ALTER SEQUENCE tasks_id_seq OWNED BY tasks.id",
+            R"(
+            CREATE TABLE tasks_archive (
+                id INT NOT NULL,
+                processing_type VARCHAR(255) NOT NULL,
+                status VARCHAR(255) NOT NULL,
+                created_at TIMESTAMP NOT NULL,
+                completed_at TIMESTAMP NULL,
+                duration INTERVAL NULL,
+                image_id INT NOT NULL,
+                priority SMALLINT NOT NULL DEFAULT 0,
+                started_at TIMESTAMP NULL,
+                trace_id VARCHAR(32),
+                processed_path TEXT,
+                output_options TEXT NOT NULL DEFAULT '',
+                PRIMARY KEY (id, created_at),
+                CONSTRAINT fk_archive_image FOREIGN KEY (image_id)
+                REFERENCES images(id) ON DELETE CASCADE
+            ) PARTITION BY RANGE (created_at)
+            )",
+            // Помісячна секція parent_YYYY_MM; storage - параметри зберігання секції
+            R"(
+            CREATE OR REPLACE FUNCTION create_monthly_partition(parent TEXT, month DATE, storage TEXT DEFAULT '')
+            RETURNS VOID AS $$
+            DECLARE
+                start_date DATE := date_trunc('month', month)::DATE;
+                partition_name TEXT := parent || '_' || to_char(start_date, 'YYYY_MM');
+            BEGIN
+                IF to_regclass(partition_name) IS NULL THEN
+                    EXECUTE format('CREATE TABLE %I PARTITION OF %I FOR VALUES FROM (%L) TO (%L) %s',
+                                   partition_name, parent, start_date,
+                                   (start_date + INTERVAL '1 month')::DATE, storage);
+                END IF;
+            END;
+            $$ LANGUAGE plpgsql
+            )",
+            R"(
+            SELECT create_monthly_partition('tasks', m::DATE)
+            FROM generate_series(
+                date_trunc('month', LEAST(COALESCE((SELECT MIN(created_at) FROM tasks_legacy), CURRENT_TIMESTAMP),
+                                          CURRENT_TIMESTAMP)),
+                date_trunc('month', CURRENT_TIMESTAMP) + INTERVAL '2 months',
+                INTERVAL '1 month') AS m
+            )",
+            R"(
+            INSERT INTO tasks (id, processing_type, status, created_at, completed_at, duration, image_id,
+                               priority, started_at, trace_id, processed_path, output_options)
+            SELECT id, processing_type, status, COALESCE(created_at, CURRENT_TIMESTAMP), completed_at, duration,
+                   image_id, priority, started_at, trace_id, processed_path, output_options
+            FROM tasks_legacy
+            )",
+            "DROP TABLE tasks_legacy",
+            "ALTER TABLE tasks ADD PRIMARY KEY (id, created_at)",
+            "CREATE INDEX idx_tasks_image_id ON tasks(image_id)",
+            "CREATE INDEX idx_tasks_active ON tasks(status, created_at) WHERE status IN ('pending', 'processing')",
+            "CREATE INDEX idx_tasks_archive_image_id ON tasks_archive(image_id)"
+        }},
+        // Перцептивний хеш (dHash) оригіналу; phash_at - час обчислення для
+        // інкрементального оновлення SimilarityIndex (NULL phash з phash_at - не декодується).
+        // Індекс по phash_at будується окремим кроком 13 без блокування images
+        {10, "images_phash", true, {
+            "ALTER TABLE images ADD COLUMN IF NOT EXISTS phash BIGINT",
+            "ALTER TABLE images ADD COLUMN IF NOT EXISTS phash_at TIMESTAMP"
+        }},
+        // Оренда завдань обробниками: кілька обробників без дублювання роботи,
+        // прострочена оренда повертає завдання в обробку, attempts обмежує повтори
+        {11, "tasks_leases", true, {
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS worker_id VARCHAR(128)",
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS lease_expires_at TIMESTAMP",
+            "ALTER TABLE tasks ADD COLUMN IF NOT EXISTS attempts SMALLINT NOT NULL DEFAULT 0",
+            "ALTER TABLE tasks_archive ADD COLUMN IF NOT EXISTS worker_id VARCHAR(128)",
+            "ALTER TABLE tasks_archive ADD COLUMN IF NOT EXISTS lease_expires_at TIMESTAMP",
+            "ALTER TABLE tasks_archive ADD COLUMN IF NOT EXISTS attempts SMALLINT NOT NULL DEFAULT 0"
+        }},
+        // Запит, що зараз завантажує частину в R2, утримує зміщення сесії
+        // (claim_token до claim_expires_at); індекс для пошуку покинутих сесій
+        {12, "upload_session_claims", true, {
+            "ALTER TABLE upload_sessions ADD COLUMN IF NOT EXISTS claim_token VARCHAR(32)",
+            "ALTER TABLE upload_sessions ADD COLUMN IF NOT EXISTS claim_expires_at TIMESTAMP",
+            "CREATE INDEX IF NOT EXISTS idx_upload_sessions_active ON upload_sessions(updated_at) WHERE status = 'active'"
+        }},
+        // Раніше індекс будувався у транзакційному кроці 10 під SHARE lock на images;
+        // на базах, де він уже є, IF NOT EXISTS нічого не робить
+        {13, "images_phash_at_index", false, {
+            "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_images_phash_at ON images(phash_at)"
+        }},
+        // Секція DEFAULT (створювалась кроком 9) забороняла пізніше створити секцію
+        // місяця, рядки якого вже потрапили в неї, і DETACH PARTITION CONCURRENTLY.
+        // Її рядки переносяться у помісячні секції; без секції вставка падає явно
+        {14, "drop_tasks_default_partition", true, {
+            R"(
+            DO $$
+            DECLARE
+                partition_month DATE;
+            BEGIN
+                IF to_regclass('tasks_default') IS NULL THEN
+                    RETURN;
+                END IF;
+                ALTER TABLE tasks DETACH PARTITION tasks_default;
+                FOR partition_month IN SELECT DISTINCT date_trunc('month', created_at)::DATE FROM tasks_default LOOP
+                    PERFORM create_monthly_partition('tasks', partition_month);
+                END LOOP;
+                INSERT INTO tasks (id, processing_type, status, created_at, completed_at, duration, image_id,
+                                   priority, started_at, trace_id, processed_path, output_options,
+                                   worker_id, lease_expires_at, attempts)
+                SELECT id, processing_type, status, created_at, completed_at, duration, image_id,
+                       priority, started_at, trace_id, processed_path, output_options,
+                       worker_id, lease_expires_at, attempts
+                FROM tasks_default;
+                DROP TABLE tasks_default;
+            END
+            $$
+            )"
+        }},
+    };
+    return list;
+}
+
+int MigrationManager::currentVersion() {
+    try {
+        pqxx::nontransaction txn(connection);
+        pqxx::result result = txn.exec("SELECT COALESCE(MAX(version), 0) FROM schema_migrations");
+        return result[0][0].as<int>();
+    } catch (const pqxx::undefined_table&) {
+        // Перший запуск на цій базі
+        return 0;
+    }
+}
+
+void MigrationManager::ensureMigrationsTable() {
+    pqxx::nontransaction txn(connection);
+    txn.exec(R"(
+        CREATE TABLE IF NOT EXISTS schema_migrations (
+            version INT PRIMARY KEY,
+            name VARCHAR(255) NOT NULL,
+            applied_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+        )
+    )");
+}
+
+void MigrationManager::apply(const Migration& migration) {
+    std::cout << "Застосування міграції " << migration.version << " (" << migration.name << ")" << std::endl;
+
+    const std::string record_sql =
+        "INSERT INTO schema_migrations (version, name) VALUES ($1, $2) ON CONFLICT (version) DO NOTHING";
+
+    if (migration.transactional) {
+        pqxx::work txn(connection);
+        // Не чекаємо довго на блокування гарячих таблиць - краще впасти і повторити
+        txn.exec("SET LOCAL lock_timeout = '5s'");
+        for (const auto& statement : migration.statements) {
+            txn.exec(statement);
+        }
+        txn.exec_params(record_sql, migration.version, migration.name);
+        txn.commit();
+        return;
+    }
+
+    // Кожна інструкція - окремий запит поза транзакцією. Інструкції мають бути
+    // ідемпотентними, бо при збої крок повториться з початку
+    pqxx::nontransaction txn(connection);
+    for (const auto& statement : migration.statements) {
+        dropInvalidIndex(txn, concurrentIndexName(statement));
+        txn.exec(statement);
+    }
+    txn.exec_params(record_sql, migration.version, migration.name);
+}
+
+// Перерваний CREATE INDEX CONCURRENTLY залишає індекс у стані INVALID, і
+// IF NOT EXISTS потім його пропускає. Такий залишок видаляється перед повтором
+void MigrationManager::dropInvalidIndex(pqxx::nontransaction& txn, const std::string& index_name) {
+    if (index_name.empty()) {
+        return;
+    }
+    pqxx::result result = txn.exec_params(R"(
+        SELECT 1 FROM pg_index i
+        JOIN pg_class c ON c.oid = i.indexrelid
+        WHERE c.relname = $1 AND pg_table_is_visible(c.oid) AND NOT i.indisvalid
+    )", index_name);
+    if (result.empty()) {
+        return;
+    }
+    std::cout << "Видалення невалідного індексу " << index_name << " після перерваної міграції" << std::endl;
+    txn.exec("DROP INDEX CONCURRENTLY IF EXISTS " + txn.quote_name(index_name));
+}
+
+// Очікування advisory lock без відкритої транзакції. Блокуючий pg_advisory_lock
+// тримає снапшот, на який чекає CREATE INDEX CONCURRENTLY екземпляра, що вже
+// мігрує - обидва чекали б один одного. false, якщо схему тим часом уже оновили
+bool MigrationManager::acquireLock(int latest) {
+    bool reported = false;
+    while (true) {
+        {
+            pqxx::nontransaction txn(connection);
+            pqxx::result result = txn.exec_params("SELECT pg_try_advisory_lock($1)", MIGRATION_LOCK_KEY);
+            if (result[0][0].as<bool>()) {
+                return true;
+            }
+        }
+        if (!reported) {
+            std::cout << "Міграцію виконує інший екземпляр, очікування..." << std::endl;
+            reported = true;
+        }
+        std::this_thread::sleep_for(LOCK_RETRY_INTERVAL);
+        if (currentVersion() >= latest) {
+            return false;
+        }
+    }
+}
+
+bool MigrationManager::migrate() {
+    const int latest = migrations().back().version;
+
+    try {
+        // Швидкий шлях: схема вже актуальна
+        int version = currentVersion();
+        if (version >= latest) {
+            std::cout << "Схема бази даних актуальна (версія " << version << ")" << std::endl;
+            return true;
+        }
+
+        if (!acquireLock(latest)) {
+            std::cout << "Схема бази даних оновлена іншим екземпляром до версії " << latest << std::endl;
+            return true;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка перевірки версії схеми: " << e.what() << std::endl;
+        return false;
+    }
+
+    bool success = true;
+    try {
+        ensureMigrationsTable();
+
+        // Інший екземпляр міг застосувати міграції, поки ми чекали блокування
+        int version = currentVersion();
+        for (const auto& migration : migrations()) {
+            if (migration.version > version) {
+                apply(migration);
+            }
+        }
+        std::cout << "Схема бази даних оновлена до версії " << latest << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка міграції схеми: " << e.what() << std::endl;
+        success = false;
+    }
+
+    try {
+        pqxx::nontransaction unlock_txn(connection);
+        unlock_txn.exec_params("SELECT pg_advisory_unlock($1)", MIGRATION_LOCK_KEY);
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка зняття блокування міграцій: " << e.what() << std::endl;
+    }
+
+    return success;
+}
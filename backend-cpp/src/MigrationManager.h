@@ -0,0 +1,38 @@
+#ifndef MIGRATION_MANAGER_H
+#define MIGRATION_MANAGER_H
+
+#include <pqxx/pqxx>
+#include <vector>
+#include <string>
+
+// Один крок міграції схеми
+struct Migration {
+    int version;
+    std::string name;
+    // Нетранзакційні кроки потрібні для CREATE INDEX CONCURRENTLY,
+    // кожна інструкція виконується окремим запитом
+    bool transactional;
+    std::vector<std::string> statements;
+};
+
+// Версіоновані міграції схеми. Застосовані версії зберігаються в таблиці
+// schema_migrations, тому звичайний запуск - це одна перевірка MAX(version)
+class MigrationManager {
+private:
+    pqxx::connection& connection;
+
+    static const std::vector<Migration>& migrations();
+    int currentVersion();
+    void ensureMigrationsTable();
+    void apply(const Migration& migration);
+    void dropInvalidIndex(pqxx::nontransaction& txn, const std::string& index_name);
+    bool acquireLock(int latest);
+
+public:
+    MigrationManager(pqxx::connection& conn);
+
+    // Застосовує лише відсутні кроки; false якщо міграція не вдалася
+    bool migrate();
+};
+
+#endif
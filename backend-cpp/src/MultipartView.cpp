@@ -0,0 +1,134 @@
+#include "MultipartView.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const std::string_view CRLF = "\r\n";
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+}
+
+// boundary=... з заголовка Content-Type, можливо в лапках
+std::string_view MultipartView::boundaryOf(std::string_view content_type) {
+    if (content_type.size() < 19 || !equalsIgnoreCase(content_type.substr(0, 19), "multipart/form-data")) {
+        return {};
+    }
+    return headerParam(content_type, "boundary");
+}
+
+// Значення параметра name=value або name="value" у заголовку
+std::string_view MultipartView::headerParam(std::string_view header, std::string_view param) {
+    size_t pos = 0;
+    while ((pos = header.find(';', pos)) != std::string_view::npos) {
+        std::string_view rest = trim(header.substr(pos + 1));
+        size_t eq = rest.find('=');
+        if (eq != std::string_view::npos && equalsIgnoreCase(trim(rest.substr(0, eq)), param)) {
+            std::string_view value = trim(rest.substr(eq + 1));
+            if (!value.empty() && value.front() == '"') {
+                size_t close = value.find('"', 1);
+                return close == std::string_view::npos ? std::string_view() : value.substr(1, close - 1);
+            }
+            return trim(value.substr(0, value.find(';')));
+        }
+        ++pos;
+    }
+    return {};
+}
+
+void MultipartView::parseHeaders(std::string_view headers, MultipartPart& part) {
+    while (!headers.empty()) {
+        size_t end = headers.find(CRLF);
+        std::string_view line = headers.substr(0, end);
+        headers = end == std::string_view::npos ? std::string_view() : headers.substr(end + CRLF.size());
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string_view name = trim(line.substr(0, colon));
+        std::string_view value = trim(line.substr(colon + 1));
+        if (equalsIgnoreCase(name, "Content-Disposition")) {
+            part.name = headerParam(value, "name");
+            part.filename = headerParam(value, "filename");
+        } else if (equalsIgnoreCase(name, "Content-Type")) {
+            part.content_type = value;
+        }
+    }
+}
+
+bool MultipartView::parse(std::string_view content_type, std::string_view body) {
+    parts.clear();
+    std::string_view boundary = boundaryOf(content_type);
+    if (boundary.empty()) {
+        return false;
+    }
+    // Роздільник між частинами: CRLF--boundary; перший може стояти на початку тіла
+    std::string delimiter = "\r\n--" + std::string(boundary);
+    std::string_view first(delimiter.data() + CRLF.size(), delimiter.size() - CRLF.size());
+
+    size_t pos;
+    if (body.substr(0, first.size()) == first) {
+        pos = first.size();
+    } else {
+        pos = body.find(delimiter);
+        if (pos == std::string_view::npos) {
+            return false;
+        }
+        pos += delimiter.size();
+    }
+
+    while (true) {
+        // "--" після роздільника - кінець форми
+        if (body.substr(pos, 2) == "--") {
+            return true;
+        }
+        if (body.substr(pos, CRLF.size()) != CRLF) {
+            return false;
+        }
+        pos += CRLF.size();
+
+        size_t headers_end = body.find("\r\n\r\n", pos);
+        if (headers_end == std::string_view::npos) {
+            return false;
+        }
+        size_t body_start = headers_end + 4;
+        size_t body_end = body.find(delimiter, body_start);
+        if (body_end == std::string_view::npos) {
+            return false;
+        }
+
+        MultipartPart part;
+        parseHeaders(body.substr(pos, headers_end - pos), part);
+        part.body = body.substr(body_start, body_end - body_start);
+        parts.push_back(part);
+
+        pos = body_end + delimiter.size();
+    }
+}
+
+const MultipartPart* MultipartView::get(std::string_view name) const {
+    for (const auto& part : parts) {
+        if (part.name == name) {
+            return &part;
+        }
+    }
+    return nullptr;
+}
+
+std::string MultipartView::field(std::string_view name) const {
+    const MultipartPart* part = get(name);
+    return part ? std::string(part->body) : std::string();
+}
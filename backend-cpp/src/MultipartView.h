@@ -0,0 +1,37 @@
+#ifndef MULTIPART_VIEW_H
+#define MULTIPART_VIEW_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Частина multipart/form-data; усі поля вказують у буфер тіла запиту
+struct MultipartPart {
+    std::string_view name;
+    std::string_view filename;
+    std::string_view content_type;
+    std::string_view body;
+};
+
+// Розбір multipart/form-data без копіювання частин (на відміну від
+// crow::multipart::message). Тіло може бути відображеним файлом (SpooledBody),
+// тож файл у формі ніколи не копіюється в пам'ять
+class MultipartView {
+private:
+    std::vector<MultipartPart> parts;
+
+    static std::string_view boundaryOf(std::string_view content_type);
+    static std::string_view headerParam(std::string_view header, std::string_view param);
+    static void parseHeaders(std::string_view headers, MultipartPart& part);
+
+public:
+    // false - не multipart або пошкоджене тіло
+    bool parse(std::string_view content_type, std::string_view body);
+
+    // nullptr, якщо частини немає
+    const MultipartPart* get(std::string_view name) const;
+    // Значення текстового поля або "" (як crow::multipart::message для відсутніх полів)
+    std::string field(std::string_view name) const;
+};
+
+#endif
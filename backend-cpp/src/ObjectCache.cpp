@@ -0,0 +1,182 @@
+#include "ObjectCache.h"
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <cstdio>
+#include <cctype>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ObjectCache::ObjectCache(const std::string& cache_dir, unsigned long long max_cache_bytes)
+    : dir(cache_dir + "/objects"), max_bytes(max_cache_bytes), current_bytes(0), temp_counter(0) {
+    // Відповідність ключ -> файл зберігається лише в пам'яті, тому залишки
+    // попереднього запуску видаляються (тільки у власній піддиректорії)
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Не вдалося створити директорію кешу " << dir << ": " << ec.message() << std::endl;
+    }
+}
+
+std::string ObjectCache::pathFor(const std::string& key) const {
+    // Ключ містить ім'я файлу від користувача, тому залишаємо лише безпечні символи
+    std::string safe = key;
+    for (auto& c : safe) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    std::stringstream name;
+    name << std::hex << std::hash<std::string>{}(key) << "_" << safe;
+    return dir + "/" + name.str();
+}
+
+ObjectCache::File::File(File&& other) noexcept
+    : fd(other.fd), file_size(other.file_size), file_path(std::move(other.file_path)) {
+    other.fd = -1;
+    other.file_size = 0;
+}
+
+ObjectCache::File& ObjectCache::File::operator=(File&& other) noexcept {
+    if (this != &other) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = other.fd;
+        file_size = other.file_size;
+        file_path = std::move(other.file_path);
+        other.fd = -1;
+        other.file_size = 0;
+    }
+    return *this;
+}
+
+ObjectCache::File::~File() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+ObjectCache::File ObjectCache::openFile(const std::string& path) {
+    File file;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return file;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return file;
+    }
+    file.fd = fd;
+    file.file_size = static_cast<unsigned long long>(st.st_size);
+    file.file_path = path;
+    return file;
+}
+
+ObjectCache::File ObjectCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    purgeRetiredLocked();
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return File();
+    }
+    lru.splice(lru.begin(), lru, it->second.lru_it);
+    // Відкриваємо під mutex, щоб паралельне витіснення не видалило файл раніше
+    return openFile(it->second.path);
+}
+
+std::string ObjectCache::tempPath(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pathFor(key) + ".tmp" + std::to_string(++temp_counter);
+}
+
+ObjectCache::File ObjectCache::insert(const std::string& key, const std::string& temp_path,
+                                      unsigned long long size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    purgeRetiredLocked();
+
+    if (size > max_bytes) {
+        // Не витісняємо весь кеш заради одного об'єкта: віддаємо його без кешування
+        File file = openFile(temp_path);
+        retireLocked(temp_path);
+        return file;
+    }
+
+    // Інший потік міг завантажити цей самий об'єкт паралельно
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        std::remove(temp_path.c_str());
+        lru.splice(lru.begin(), lru, it->second.lru_it);
+        return openFile(it->second.path);
+    }
+
+    // Ім'я унікальне для кожної вставки: витіснений файл того ж ключа ще може
+    // чекати на видалення
+    std::string path = pathFor(key) + "." + std::to_string(++temp_counter);
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return File();
+    }
+
+    File file = openFile(path);
+    lru.push_front(key);
+    entries[key] = Entry{path, size, lru.begin()};
+    current_bytes += size;
+    evictLocked();
+    return file;
+}
+
+void ObjectCache::evictLocked() {
+    while (current_bytes > max_bytes && !lru.empty()) {
+        const std::string& victim = lru.back();
+        auto it = entries.find(victim);
+        retireLocked(it->second.path);
+        current_bytes -= it->second.size;
+        entries.erase(it);
+        lru.pop_back();
+    }
+}
+
+void ObjectCache::retireLocked(const std::string& path) {
+    retired.emplace_back(std::chrono::steady_clock::now(), path);
+}
+
+// Відкриті дескриптори залишаються валідними після unlink
+void ObjectCache::purgeRetiredLocked() {
+    auto deadline = std::chrono::steady_clock::now() - RETIRE_DELAY;
+    while (!retired.empty() && retired.front().first <= deadline) {
+        std::remove(retired.front().second.c_str());
+        retired.pop_front();
+    }
+}
+
+bool ObjectCache::File::readRange(unsigned long long offset, unsigned long long length,
+                                  std::string& out) const {
+    if (fd < 0 || offset + length > file_size) {
+        return false;
+    }
+    if (length == 0) {
+        out.clear();
+        return true;
+    }
+
+    // mmap потребує вирівнювання зміщення по сторінці
+    unsigned long long page = static_cast<unsigned long long>(::sysconf(_SC_PAGESIZE));
+    unsigned long long aligned = offset - (offset % page);
+    unsigned long long delta = offset - aligned;
+
+    void* mapped = ::mmap(nullptr, length + delta, PROT_READ, MAP_PRIVATE, fd, aligned);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    ::madvise(mapped, length + delta, MADV_SEQUENTIAL);
+    out.assign(static_cast<const char*>(mapped) + delta, length);
+    ::munmap(mapped, length + delta);
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef OBJECT_CACHE_H
+#define OBJECT_CACHE_H
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+// Локальний дисковий кеш об'єктів R2 з LRU витісненням за сумарним розміром у байтах.
+// Назовні віддаються відкриті дескриптори: вже відкритий файл лишається читабельним
+// після витіснення. Витіснений файл видаляється з каталогу не одразу, а через
+// RETIRE_DELAY, щоб за шляхом з File::path() його ще встигла відкрити віддача
+// файлу Crow (set_static_file_info відкриває файл уже після обробника)
+class ObjectCache {
+public:
+    // Відкритий файл об'єкта; дескриптор закривається в деструкторі
+    class File {
+    private:
+        int fd = -1;
+        unsigned long long file_size = 0;
+        std::string file_path;
+        friend class ObjectCache;
+
+    public:
+        File() = default;
+        File(File&& other) noexcept;
+        File& operator=(File&& other) noexcept;
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+        ~File();
+
+        bool valid() const { return fd >= 0; }
+        unsigned long long size() const { return file_size; }
+        // Шлях лишається дійсним щонайменше RETIRE_DELAY після витіснення
+        const std::string& path() const { return file_path; }
+        // Читання діапазону файлу через mmap
+        bool readRange(unsigned long long offset, unsigned long long length, std::string& out) const;
+    };
+
+private:
+    struct Entry {
+        std::string path;
+        unsigned long long size;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    std::string dir;
+    unsigned long long max_bytes;
+    unsigned long long current_bytes;
+    unsigned long long temp_counter;
+
+    std::mutex mutex;
+    std::list<std::string> lru;  // ключі, на початку - найновіші
+    std::unordered_map<std::string, Entry> entries;
+    // Витіснені файли, що чекають на видалення з каталогу
+    std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> retired;
+
+    std::string pathFor(const std::string& key) const;
+    // Викликаються під mutex
+    void evictLocked();
+    void retireLocked(const std::string& path);
+    void purgeRetiredLocked();
+    static File openFile(const std::string& path);
+
+public:
+    static constexpr std::chrono::seconds RETIRE_DELAY{60};
+
+    ObjectCache(const std::string& cache_dir, unsigned long long max_cache_bytes);
+
+    // Відкриває локальну копію, якщо об'єкт є в кеші (інакше File невалідний)
+    File lookup(const std::string& key);
+    // Унікальний тимчасовий файл для завантаження об'єкта
+    std::string tempPath(const std::string& key);
+    // Переносить завантажений тимчасовий файл у кеш і відкриває його. Об'єкт,
+    // більший за весь кеш, не кешується: тимчасовий файл одразу стає витісненим
+    File insert(const std::string& key, const std::string& temp_path, unsigned long long size);
+};
+
+#endif
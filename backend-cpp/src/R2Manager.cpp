@@ -3,12 +3,36 @@
 #include <sstream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <aws/core/utils/memory/stl/AWSStreamFwd.h>
 
 R2Manager::R2Manager(const R2Config& r2_config)
-    : config(r2_config) {}
+    : config(r2_config),
+      cache(std::make_unique<ObjectCache>(r2_config.cache_dir, r2_config.cache_max_bytes)) {}
 
 R2Manager::~R2Manager() = default;
 
+std::shared_ptr<Aws::S3::S3Client> R2Manager::createClient(long request_timeout_ms, long connect_timeout_ms) const {
+    Aws::Client::ClientConfiguration client_config;
+    client_config.endpointOverride = config.endpoint;
+    client_config.scheme = Aws::Http::Scheme::HTTPS;
+    client_config.region = "auto";
+    client_config.requestTimeoutMs = request_timeout_ms;
+    client_config.connectTimeoutMs = connect_timeout_ms;
+
+    Aws::Auth::AWSCredentials creds(config.access_key, config.secret_key);
+
+    return Aws::MakeShared<Aws::S3::S3Client>(
+        "R2Client",
+        creds,
+        client_config,
+        Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
+        false
+    );
+}
+
 // Метод для тестування підключення до Cloudflare R2
 bool R2Manager::testConnect() {
     try {
@@ -31,13 +55,12 @@ bool R2Manager::testConnect() {
             false
         );
 
-        // Запит на отримання списку об'єктів для тестування підключення
-        Aws::S3::Model::ListObjectsV2Request request;
-        request.WithBucket(config.bucket_name);  // Вказання імені бакета
-        request.SetMaxKeys(10);                  // Обмеження кількості об'єктів
+        // HEAD запит до бакета - найдешевша перевірка доступу
+        Aws::S3::Model::HeadBucketRequest request;
+        request.SetBucket(config.bucket_name);  // Вказання імені бакета
 
         std::cout << "Тестування підключення до R2..." << std::endl;
-        auto outcome = s3_client.ListObjectsV2(request);  // Виконання запиту
+        auto outcome = s3_client.HeadBucket(request);  // Виконання запиту
         
         if (outcome.IsSuccess()) {
             std::cout << "✅ Успішно підключено до R2!" << std::endl;
@@ -54,7 +77,7 @@ bool R2Manager::testConnect() {
 }
 
 // Метод для завантаження зображення на R2
-std::string R2Manager::uploadImageToR2(const std::string& filename, const std::string& file_data , const int id ) {
+std::string R2Manager::uploadImageToR2(const std::string& filename, std::string_view file_data , const int id ) {
     try {
         // Конфігурація клієнта з більшими таймаутами для завантаження
         Aws::Client::ClientConfiguration client_config;
@@ -79,12 +102,14 @@ std::string R2Manager::uploadImageToR2(const std::string& filename, const std::s
         Aws::S3::Model::PutObjectRequest request;
         request.SetBucket(config.bucket_name);  // Вказання бакета
         // Формування ключа: original/{id}-{filename}
-        request.SetKey("original/" + std::to_string(id) + "-" + filename);
+        request.SetKey(getOriginalKey(filename, id));
 
-        // Створення потоку для даних файлу
-        auto stream = Aws::MakeShared<Aws::StringStream>("R2Upload");
-        *stream << file_data;  // Запис даних у потік
+        // Потік читає дані файлу на місці (SDK лише читає буфер)
+        Aws::Utils::Stream::PreallocatedStreamBuf buffer(
+            reinterpret_cast<unsigned char*>(const_cast<char*>(file_data.data())), file_data.size());
+        auto stream = Aws::MakeShared<Aws::IOStream>("R2Upload", &buffer);
         request.SetBody(stream);  // Встановлення тіла запиту
+        request.SetContentLength(static_cast<long long>(file_data.size()));
 
         // Виконання запиту на завантаження
         auto outcome = s3_client.PutObject(request);
@@ -106,7 +131,224 @@ std::string R2Manager::uploadImageToR2(const std::string& filename, const std::s
     }
 }
 
-std::string R2Manager::getPublicURL(const std::string& filename , const int id){
+std::string R2Manager::getPublicURL(std::string_view filename , const int id){
     // Формування публічного URL: {public_url}/original/{id}-{filename}
-    return config.public_url + "/original/" + std::to_string(id) + "-" + filename;
-}
\ No newline at end of file
+    return config.public_url + "/original/" + std::to_string(id) + "-" + std::string(filename);
+}
+
+std::string R2Manager::getPublicObjectURL(const std::string& key) const {
+    return config.public_url + "/" + key;
+}
+
+std::string R2Manager::getOriginalKey(std::string_view filename, const int id) const {
+    // Формування ключа: original/{id}-{filename}
+    return "original/" + std::to_string(id) + "-" + std::string(filename);
+}
+
+// Генерація короткочасного підписаного URL для прямого завантаження в R2 (PUT)
+std::string R2Manager::generatePresignedPutURL(const std::string& key) {
+    try {
+        // Підпис рахується локально, мережевого запиту немає
+        auto s3_client = createClient(10000, 5000);
+        Aws::String url = s3_client->GeneratePresignedUrl(
+            config.bucket_name,
+            key,
+            Aws::Http::HttpMethod::HTTP_PUT,
+            config.presign_expiry_seconds
+        );
+        return std::string(url.c_str(), url.size());
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток генерації підписаного URL: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+// HEAD запит для перевірки існування, розміру та ETag об'єкта
+R2ObjectInfo R2Manager::headObject(const std::string& key) {
+    R2ObjectInfo info;
+    try {
+        auto s3_client = createClient(10000, 5000);
+
+        Aws::S3::Model::HeadObjectRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+
+        auto outcome = s3_client->HeadObject(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ HEAD " << key << ": " << outcome.GetError().GetMessage() << std::endl;
+            return info;
+        }
+
+        info.exists = true;
+        info.size = outcome.GetResult().GetContentLength();
+
+        // ETag повертається в лапках
+        std::string etag = outcome.GetResult().GetETag().c_str();
+        etag.erase(std::remove(etag.begin(), etag.end(), '"'), etag.end());
+        std::transform(etag.begin(), etag.end(), etag.begin(), ::tolower);
+        info.etag = etag;
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток HEAD запиту R2: " << e.what() << std::endl;
+    }
+    return info;
+}
+
+// Читання об'єкта з R2 через локальний дисковий кеш (read-through)
+ObjectCache::File R2Manager::getObject(const std::string& key) {
+    ObjectCache::File cached = cache->lookup(key);
+    if (cached.valid()) {
+        return cached;
+    }
+
+    std::string temp_path = cache->tempPath(key);
+    try {
+        auto s3_client = createClient(30000, 10000);
+
+        Aws::S3::Model::GetObjectRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+        // Тіло відповіді пишеться одразу у файл, а не в пам'ять
+        request.SetResponseStreamFactory([temp_path]() {
+            return Aws::New<Aws::FStream>("R2Cache", temp_path.c_str(),
+                                          std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        });
+
+        auto outcome = s3_client->GetObject(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ GET " << key << ": " << outcome.GetError().GetMessage() << std::endl;
+            std::remove(temp_path.c_str());
+            return ObjectCache::File();
+        }
+
+        long long size = outcome.GetResult().GetContentLength();
+        // Закриваємо файл до перейменування і перевіряємо запис: обрізаний файл
+        // не повинен потрапити в кеш
+        auto* file = dynamic_cast<Aws::FStream*>(&outcome.GetResult().GetBody());
+        if (file) {
+            file->close();
+        }
+        std::error_code ec;
+        auto written = std::filesystem::file_size(temp_path, ec);
+        if (!file || file->fail() || ec || static_cast<long long>(written) != size) {
+            std::cerr << "❌ GET " << key << ": файл кешу записаний не повністю" << std::endl;
+            std::remove(temp_path.c_str());
+            return ObjectCache::File();
+        }
+        return cache->insert(key, temp_path, static_cast<unsigned long long>(size));
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток читання R2: " << e.what() << std::endl;
+        std::remove(temp_path.c_str());
+        return ObjectCache::File();
+    }
+}
+
+// Початок multipart завантаження, повертає UploadId або "" при помилці
+std::string R2Manager::createMultipartUpload(const std::string& key) {
+    try {
+        auto s3_client = createClient(10000, 5000);
+
+        Aws::S3::Model::CreateMultipartUploadRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+
+        auto outcome = s3_client->CreateMultipartUpload(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ CreateMultipartUpload " << key << ": " << outcome.GetError().GetMessage() << std::endl;
+            return "";
+        }
+        return outcome.GetResult().GetUploadId().c_str();
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток CreateMultipartUpload: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+// Завантаження однієї частини. Повторне завантаження того ж номера перезаписує частину
+std::string R2Manager::uploadPart(const std::string& key, const std::string& upload_id,
+                                  int part_number, std::string_view data) {
+    try {
+        auto s3_client = createClient(30000, 10000);
+
+        Aws::S3::Model::UploadPartRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+        request.SetUploadId(upload_id);
+        request.SetPartNumber(part_number);
+        request.SetContentLength(static_cast<long long>(data.size()));
+
+        Aws::Utils::Stream::PreallocatedStreamBuf buffer(
+            reinterpret_cast<unsigned char*>(const_cast<char*>(data.data())), data.size());
+        auto stream = Aws::MakeShared<Aws::IOStream>("R2UploadPart", &buffer);
+        request.SetBody(stream);
+
+        auto outcome = s3_client->UploadPart(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ UploadPart " << key << " #" << part_number << ": "
+                      << outcome.GetError().GetMessage() << std::endl;
+            return "";
+        }
+        return outcome.GetResult().GetETag().c_str();
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток UploadPart: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+bool R2Manager::completeMultipartUpload(const std::string& key, const std::string& upload_id,
+                                        const std::vector<std::pair<int, std::string>>& parts) {
+    try {
+        auto s3_client = createClient(30000, 10000);
+
+        Aws::S3::Model::CompletedMultipartUpload completed;
+        for (const auto& part : parts) {
+            Aws::S3::Model::CompletedPart completed_part;
+            completed_part.SetPartNumber(part.first);
+            completed_part.SetETag(part.second);
+            completed.AddParts(completed_part);
+        }
+
+        Aws::S3::Model::CompleteMultipartUploadRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+        request.SetUploadId(upload_id);
+        request.SetMultipartUpload(completed);
+
+        auto outcome = s3_client->CompleteMultipartUpload(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ CompleteMultipartUpload " << key << ": " << outcome.GetError().GetMessage() << std::endl;
+            return false;
+        }
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток CompleteMultipartUpload: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool R2Manager::abortMultipartUpload(const std::string& key, const std::string& upload_id) {
+    try {
+        auto s3_client = createClient(10000, 5000);
+
+        Aws::S3::Model::AbortMultipartUploadRequest request;
+        request.SetBucket(config.bucket_name);
+        request.SetKey(key);
+        request.SetUploadId(upload_id);
+
+        auto outcome = s3_client->AbortMultipartUpload(request);
+        if (!outcome.IsSuccess()) {
+            std::cerr << "❌ AbortMultipartUpload " << key << ": " << outcome.GetError().GetMessage() << std::endl;
+            return false;
+        }
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Виняток AbortMultipartUpload: " << e.what() << std::endl;
+        return false;
+    }
+}
@@ -7,26 +7,63 @@
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/ListObjectsV2Request.h>
+#include <aws/s3/model/HeadObjectRequest.h>
+#include <aws/s3/model/HeadBucketRequest.h>
+#include <aws/core/http/HttpTypes.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/core/utils/stream/PreallocatedStreamBuf.h>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <iostream>
 #include "models/Image.h"
+#include "ObjectCache.h"
 #include "config/Config.h"
 
+// Метадані об'єкта, отримані через HEAD запит
+struct R2ObjectInfo {
+    bool exists = false;
+    long long size = 0;
+    std::string etag;  // для звичайного PUT дорівнює MD5 вмісту (hex)
+};
+
 class R2Manager {
 private:
     
     R2Config config;
+    std::unique_ptr<ObjectCache> cache;
     
-
+    // Створення S3 клієнта для R2 з заданими таймаутами
+    std::shared_ptr<Aws::S3::S3Client> createClient(long request_timeout_ms, long connect_timeout_ms) const;
     
 public:
     R2Manager(const R2Config& r2_config);
     ~R2Manager();
-    std::string getPublicURL(const std::string& filename , const int id);
+    std::string getPublicURL(std::string_view filename , const int id);
+    std::string getPublicObjectURL(const std::string& key) const;
     bool testConnect();
-    std::string uploadImageToR2(const std::string& filename, const std::string& file_data , const int id);
+    // file_data може вказувати у відображений тимчасовий файл - передається в SDK без копії
+    std::string uploadImageToR2(const std::string& filename, std::string_view file_data , const int id);
+    std::string getOriginalKey(std::string_view filename, const int id) const;
+    std::string generatePresignedPutURL(const std::string& key);
+    long long getPresignExpirySeconds() const { return config.presign_expiry_seconds; }
+    R2ObjectInfo headObject(const std::string& key);
+    // Отримання об'єкта через локальний кеш; при помилці повертає невалідний File
+    ObjectCache::File getObject(const std::string& key);
+
+    // Multipart завантаження (для відновлюваних завантажень частинами)
+    long long getMultipartPartSize() const { return config.multipart_part_size; }
+    std::string createMultipartUpload(const std::string& key);
+    // Повертає ETag частини або "" при помилці
+    std::string uploadPart(const std::string& key, const std::string& upload_id,
+                           int part_number, std::string_view data);
+    bool completeMultipartUpload(const std::string& key, const std::string& upload_id,
+                                 const std::vector<std::pair<int, std::string>>& parts);
+    bool abortMultipartUpload(const std::string& key, const std::string& upload_id);
     //Image getImageFromS3(int id);
     //int countFiles();
     //bool deleteImageFromS3(int id);
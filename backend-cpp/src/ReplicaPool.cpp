@@ -0,0 +1,167 @@
+#include "ReplicaPool.h"
+#include <iostream>
+#include <chrono>
+
+ReplicaPool::ReplicaPool(const DatabaseConfig& config)
+    : max_lag_ms(config.replica_max_lag_ms),
+      check_interval_ms(config.replica_check_interval_ms),
+      next(0),
+      stopping(false) {
+    for (const auto& replica_host : config.replica_hosts) {
+        auto replica = std::make_unique<Replica>();
+        replica->host = replica_host.host + ":" + replica_host.port;
+        replica->connection_string = config.getConnectionString(replica_host.host, replica_host.port);
+        replicas.push_back(std::move(replica));
+    }
+}
+
+ReplicaPool::~ReplicaPool() {
+    stop();
+}
+
+// Перша перевірка синхронна, щоб читання йшли на репліки одразу після старту
+void ReplicaPool::start() {
+    if (replicas.empty() || monitor.joinable()) {
+        return;
+    }
+    for (auto& replica : replicas) {
+        std::lock_guard<std::mutex> lock(replica->mutex);
+        checkLocked(*replica);
+        if (!replica->healthy) {
+            std::cerr << "Репліка " << replica->host << " недоступна при старті, читання з primary" << std::endl;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        stopping = false;
+    }
+    monitor = std::thread(&ReplicaPool::monitorLoop, this);
+}
+
+void ReplicaPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (monitor.joinable()) {
+        monitor.join();
+    }
+}
+
+bool ReplicaPool::eligible(const Replica& replica) const {
+    return replica.healthy.load(std::memory_order_acquire) &&
+           replica.lag_ms.load(std::memory_order_relaxed) <= max_lag_ms;
+}
+
+// Оновлення відставання репліки. Якщо весь отриманий WAL уже застосовано,
+// відставання 0 (інакше на простої primary час останньої транзакції старіє).
+// Це вірно лише поки WAL receiver з'єднаний з primary: після розриву receive
+// і replay LSN теж рівні, але репліка вже нічого не отримує - вона непридатна
+void ReplicaPool::checkLocked(Replica& replica) {
+    try {
+        if (!replica.connection || !replica.connection->is_open()) {
+            replica.connection = std::make_unique<pqxx::connection>(replica.connection_string);
+            std::cout << "Підключено до репліки " << replica.host << std::endl;
+        }
+
+        pqxx::nontransaction txn(*replica.connection);
+        pqxx::result result = txn.exec(R"(
+            SELECT
+                NOT pg_is_in_recovery()
+                    OR EXISTS (SELECT 1 FROM pg_stat_wal_receiver WHERE status = 'streaming'),
+                CASE
+                    WHEN NOT pg_is_in_recovery() THEN 0
+                    WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0
+                    ELSE COALESCE(EXTRACT(EPOCH FROM (now() - pg_last_xact_replay_timestamp())) * 1000, 0)
+                END::BIGINT
+        )");
+
+        if (!result[0][0].as<bool>()) {
+            if (replica.healthy.exchange(false, std::memory_order_release)) {
+                std::cerr << "Репліка " << replica.host << " не отримує WAL від primary, читання з primary" << std::endl;
+            }
+            return;
+        }
+
+        long long lag = result[0][1].as<long long>();
+        long long previous_lag = replica.lag_ms.exchange(lag, std::memory_order_relaxed);
+        bool was_healthy = replica.healthy.exchange(true, std::memory_order_release);
+        if (!was_healthy) {
+            std::cout << "Репліка " << replica.host << " доступна, відставання " << lag << " мс" << std::endl;
+        }
+        if (lag > max_lag_ms && (previous_lag <= max_lag_ms || !was_healthy)) {
+            std::cerr << "Репліка " << replica.host << " відстає на " << lag << " мс, читання з primary" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        // Повідомляємо лише про перехід у недоступний стан, не на кожну спробу
+        if (replica.healthy.exchange(false, std::memory_order_release)) {
+            std::cerr << "Репліка " << replica.host << " недоступна: " << e.what() << std::endl;
+        }
+        replica.connection.reset();
+    }
+}
+
+void ReplicaPool::monitorLoop() {
+    std::unique_lock<std::mutex> lock(monitor_mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(check_interval_ms), [this]() { return stopping; });
+        if (stopping) {
+            break;
+        }
+        lock.unlock();
+        for (auto& replica : replicas) {
+            std::lock_guard<std::mutex> replica_lock(replica->mutex);
+            checkLocked(*replica);
+        }
+        lock.lock();
+    }
+}
+
+// Round-robin серед придатних реплік: спочатку вільна, інакше чекаємо першу придатну
+ReplicaPool::Lease ReplicaPool::acquire() {
+    Lease lease;
+    if (replicas.empty()) {
+        return lease;
+    }
+
+    size_t start = next.fetch_add(1, std::memory_order_relaxed);
+    Replica* fallback = nullptr;
+
+    for (size_t i = 0; i < replicas.size(); ++i) {
+        Replica* replica = replicas[(start + i) % replicas.size()].get();
+        if (!eligible(*replica)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(replica->mutex, std::try_to_lock);
+        if (lock.owns_lock() && replica->connection && eligible(*replica)) {
+            lease.lock = std::move(lock);
+            lease.replica = replica;
+            return lease;
+        }
+        if (!fallback) {
+            fallback = replica;
+        }
+    }
+
+    if (fallback) {
+        std::unique_lock<std::mutex> lock(fallback->mutex);
+        // Стан міг змінитися, поки чекали
+        if (fallback->connection && eligible(*fallback)) {
+            lease.lock = std::move(lock);
+            lease.replica = fallback;
+        }
+    }
+    return lease;
+}
+
+void ReplicaPool::markBroken(Lease& lease) {
+    if (!lease) {
+        return;
+    }
+    lease.replica->healthy.store(false, std::memory_order_release);
+    lease.replica->connection.reset();
+    lease.lock.unlock();
+    lease.replica = nullptr;
+}
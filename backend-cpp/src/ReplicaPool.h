@@ -0,0 +1,70 @@
+#ifndef REPLICA_POOL_H
+#define REPLICA_POOL_H
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config/Config.h"
+
+// Пул з'єднань до реплік для читання. Фоновий потік перевіряє відставання
+// кожної репліки і перепідключає недоступні; acquire() видає лише репліки
+// з відставанням у межах replica_max_lag_ms
+class ReplicaPool {
+private:
+    struct Replica {
+        std::string host;
+        std::string connection_string;
+        std::mutex mutex;  // одне з'єднання pqxx - один запит одночасно
+        std::unique_ptr<pqxx::connection> connection;
+        std::atomic<bool> healthy{false};
+        std::atomic<long long> lag_ms{0};
+    };
+
+    std::vector<std::unique_ptr<Replica>> replicas;
+    long long max_lag_ms;
+    int check_interval_ms;
+    std::atomic<size_t> next;
+
+    std::thread monitor;
+    std::mutex monitor_mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    bool eligible(const Replica& replica) const;
+    // Викликається під mutex репліки
+    void checkLocked(Replica& replica);
+    void monitorLoop();
+
+public:
+    // З'єднання репліки, заблоковане на час запиту. Порожнє - читати з primary
+    class Lease {
+    private:
+        std::unique_lock<std::mutex> lock;
+        Replica* replica = nullptr;
+        friend class ReplicaPool;
+
+    public:
+        Lease() = default;
+        explicit operator bool() const { return replica != nullptr; }
+        pqxx::connection& operator*() const { return *replica->connection; }
+        const std::string& host() const { return replica->host; }
+    };
+
+    explicit ReplicaPool(const DatabaseConfig& config);
+    ~ReplicaPool();
+
+    void start();
+    void stop();
+    bool empty() const { return replicas.empty(); }
+
+    Lease acquire();
+    // Запит на репліці втратив з'єднання - виключаємо її до наступної перевірки
+    void markBroken(Lease& lease);
+};
+
+#endif
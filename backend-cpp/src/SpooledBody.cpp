@@ -0,0 +1,66 @@
+#include "SpooledBody.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SpooledBody::SpooledBody()
+    : fd(-1), data(nullptr), size(0) {
+}
+
+SpooledBody::~SpooledBody() {
+    if (data) {
+        munmap(data, size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+std::unique_ptr<SpooledBody> SpooledBody::create(const std::string& dir, const std::string& body) {
+    if (body.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<SpooledBody> spooled(new SpooledBody());
+
+    std::string pattern = dir + "/upload-XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    spooled->fd = mkstemp(path.data());
+    if (spooled->fd < 0) {
+        std::cerr << "Не вдалося створити тимчасовий файл у " << dir << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    unlink(path.data());
+
+    size_t written = 0;
+    while (written < body.size()) {
+        ssize_t n = write(spooled->fd, body.data() + written, body.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Не вдалося записати тіло запиту у тимчасовий файл: " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    void* mapped = mmap(nullptr, body.size(), PROT_READ, MAP_SHARED, spooled->fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Не вдалося відобразити тимчасовий файл: " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    // Розбір і завантаження в R2 читають файл послідовно
+    madvise(mapped, body.size(), MADV_SEQUENTIAL);
+    spooled->data = mapped;
+    spooled->size = body.size();
+    return spooled;
+}
+
+std::string_view SpooledBody::view() const {
+    return std::string_view(static_cast<const char*>(data), size);
+}
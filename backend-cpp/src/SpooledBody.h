@@ -0,0 +1,32 @@
+#ifndef SPOOLED_BODY_H
+#define SPOOLED_BODY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Тіло запиту, перенесене з пам'яті у тимчасовий файл і відображене через mmap
+// лише для читання. Сторінки файлу ядро може витіснити, тож великі тіла не
+// займають резидентну пам'ять процесу. Файл видаляється з каталогу одразу
+// після створення - після збою процесу нічого не залишається
+class SpooledBody {
+private:
+    int fd;
+    void* data;
+    size_t size;
+
+    SpooledBody();
+
+public:
+    // nullptr при помилці (немає місця, каталог недоступний)
+    static std::unique_ptr<SpooledBody> create(const std::string& dir, const std::string& body);
+    ~SpooledBody();
+
+    SpooledBody(const SpooledBody&) = delete;
+    SpooledBody& operator=(const SpooledBody&) = delete;
+
+    std::string_view view() const;
+};
+
+#endif
@@ -4,6 +4,11 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include "models/TimeFormat.h"
+#include "tracing/Tracer.h"
+#include "models/OutputOptions.h"
+#include "IdList.h"
+#include <unordered_map>
 
 TaskController::TaskController(DatabaseManager& db, R2Manager& r2_manager)
     : db_manager(db), r2_manager(r2_manager) {
@@ -23,10 +28,64 @@ crow::response TaskController::createTask(const crow::request& req) {
         std::string processing_type = msg.get_part_by_name("processing_type").body;
         std::cout << "   Processing_type: " << processing_type << std::endl;
 
+        ProcessingType type = processingTypeFromString(processing_type);
+        if (type == ProcessingType::Unknown) {
+            return crow::response(400, "Невідомий тип обробки");
+        }
+
+        // Необов'язковий пріоритет завдання (0 - звичайний)
+        int priority = 0;
+        std::string priority_str = msg.get_part_by_name("priority").body;
+        if (!priority_str.empty()) {
+            try {
+                priority = std::stoi(priority_str);
+            } catch (const std::exception&) {
+                return crow::response(400, "Невірний пріоритет");
+            }
+            if (priority < -10 || priority > 10) {
+                return crow::response(400, "Пріоритет має бути в межах від -10 до 10");
+            }
+        }
+
+        // Необов'язкові параметри кодування результату
+        OutputOptions output_options;
+        for (const char* field : {"output_format", "quality", "progressive", "chroma_subsampling",
+                                  "strip_metadata", "mode", "min_psnr"}) {
+            std::string error;
+            if (!output_options.set(field, msg.get_part_by_name(field).body, error)) {
+                return crow::response(400, error);
+            }
+        }
+
         // Збереження завдання в базі даних
         std::cout << "Збереження завдання в базі даних" << std::endl;
-        Task new_Task(image_id , processing_type, "pending");  // Статус "очікує"
-        int Task_id = db_manager.createTask(new_Task);
+        Task new_Task(image_id , type, TaskStatus::Pending);  // Статус "очікує"
+        new_Task.priority = priority;
+        // Рядки завдання - string_view, тож значення живуть у локальних рядках до кінця запиту
+        std::string canonical_options = output_options.canonical();
+        new_Task.output_options = canonical_options;
+        // trace id запиту зберігається з завданням, щоб обробник продовжив трасу
+        tracing::SpanContext trace_context = tracing::Tracer::current();
+        if (trace_context.valid()) {
+            new_Task.trace_id = trace_context.traceIdHex();
+        }
+        // Той самий вміст уже оброблявся цим типом - завдання завершується одразу
+        std::string cached_path;
+        {
+            tracing::Span cache_span("db.findCachedResult");
+            cached_path = db_manager.findCachedResult(image_id, type, canonical_options);
+        }
+        new_Task.processed_path = cached_path;
+        if (!new_Task.processed_path.empty()) {
+            std::cout << "   Знайдено готовий результат: " << new_Task.processed_path << std::endl;
+            new_Task.status = TaskStatus::Completed;
+        }
+
+        int Task_id;
+        {
+            tracing::Span db_span("db.createTask");
+            Task_id = db_manager.createTask(new_Task);
+        }
         
         // Перевірка успішності створення завдання
         if (Task_id == -1) {
@@ -41,7 +100,12 @@ crow::response TaskController::createTask(const crow::request& req) {
         response["image_id"] = image_id;
         response["id"] = Task_id ;
         response["processing_type"] = processing_type;
-        response["status"] = "pending";        
+        response["priority"] = priority;
+        response["output_options"] = canonical_options;
+        response["status"] = std::string(toString(new_Task.status));
+        if (!cached_path.empty()) {
+            response["processed_url"] = r2_manager.getPublicObjectURL(cached_path);
+        }
         return crow::response(201, response);  // 201 Created
         
     } catch (const std::exception& e) {
@@ -53,21 +117,18 @@ crow::response TaskController::createTask(const crow::request& req) {
 crow::response TaskController::getTasks(const crow::request& req , int image_id ) {
     try {
         // Отримання завдань з бази даних
-        auto Tasks = db_manager.getTasks(image_id );
+        TaskList Tasks;
+        {
+            tracing::Span db_span("db.getTasks");
+            Tasks = db_manager.getTasks(image_id );
+        }
         crow::json::wvalue response;
         
         // Формування списку завдань у форматі JSON
         crow::json::wvalue::list Tasks_list;
-        for (const auto& Task : Tasks) {
-            crow::json::wvalue tsk_json;
-            tsk_json["id"] = Task.id;
-            tsk_json["image_id"] = Task.image_id;
-            tsk_json["status"] =  Task.status;
-            tsk_json["created_at"]  = Task.created_at;
-            tsk_json["completed_at"] = Task.completed_at;
-            tsk_json["duration"] = Task.duration;            
-            tsk_json["processing_type"] = Task.processing_type;
-            Tasks_list.push_back(tsk_json);  // Додавання завдання до списку
+        Tasks_list.reserve(Tasks.items.size());
+        for (const auto& Task : Tasks.items) {
+            Tasks_list.push_back(taskToJson(Task));  // Додавання завдання до списку
         }
         
         response["tasks"] = std::move(Tasks_list);  // Переміщення списку у відповідь
@@ -77,4 +138,63 @@ crow::response TaskController::getTasks(const crow::request& req , int image_id
         // Обробка помилок при отриманні завдань
         return crow::response(500, std::string("Помилка: ") + e.what());
     }
-}
\ No newline at end of file
+}
+
+crow::response TaskController::getTasksForImages(const crow::request& req) {
+    try {
+        const char* image_ids_param = req.url_params.get("image_ids");
+        if (!image_ids_param) {
+            return crow::response(400, "Параметр image_ids обов'язковий");
+        }
+
+        std::vector<int> image_ids;
+        std::string error;
+        if (!parseIdList(image_ids_param, image_ids, error)) {
+            return crow::response(400, error);
+        }
+
+        // Один запит на всі зображення, групування на сервері
+        TaskList tasks;
+        {
+            tracing::Span db_span("db.getTasksForImages");
+            db_span.setAttribute("image_count", static_cast<int>(image_ids.size()));
+            tasks = db_manager.getTasksForImages(image_ids);
+        }
+
+        std::unordered_map<int, crow::json::wvalue::list> grouped;
+        grouped.reserve(image_ids.size());
+        for (const auto& task : tasks.items) {
+            grouped[task.image_id].push_back(taskToJson(task));
+        }
+
+        // Кожен запитаний ID присутній у відповіді, навіть без завдань
+        crow::json::wvalue response;
+        for (int image_id : image_ids) {
+            auto it = grouped.find(image_id);
+            response["tasks"][std::to_string(image_id)] =
+                it == grouped.end() ? crow::json::wvalue::list{} : std::move(it->second);
+        }
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+crow::json::wvalue TaskController::taskToJson(const Task& task) {
+    crow::json::wvalue tsk_json;
+    tsk_json["id"] = task.id;
+    tsk_json["image_id"] = task.image_id;
+    tsk_json["status"] =  std::string(toString(task.status));
+    tsk_json["created_at"]  = formatTimestamp(task.created_at);
+    tsk_json["completed_at"] = task.completed_at < 0 ? "" : formatTimestamp(task.completed_at);
+    tsk_json["duration"] = task.duration < 0 ? "" : formatDuration(task.duration);
+    tsk_json["processing_type"] = std::string(toString(task.processing_type));
+    tsk_json["priority"] = task.priority;
+    tsk_json["output_options"] = std::string(task.output_options);
+    tsk_json["attempts"] = task.attempts;
+    if (!task.processed_path.empty()) {
+        tsk_json["processed_url"] = r2_manager.getPublicObjectURL(std::string(task.processed_path));
+    }
+    return tsk_json;
+}
@@ -13,11 +13,14 @@ private:
     DatabaseManager& db_manager;
     R2Manager& r2_manager;
 
+    crow::json::wvalue taskToJson(const Task& task);
     
 public:
     TaskController(DatabaseManager& db , R2Manager& r2_manager );
     crow::response createTask(const crow::request& req );
     crow::response getTasks(const crow::request& req , int image_id );
+    // GET /api/tasks?image_ids=1,2,3 - завдання, згруповані за зображенням
+    crow::response getTasksForImages(const crow::request& req);
 };
 
 
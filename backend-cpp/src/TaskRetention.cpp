@@ -0,0 +1,225 @@
+#include "TaskRetention.h"
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+// Окремий ключ від міграцій: прохід обслуговування виконує один екземпляр
+const long long RETENTION_LOCK_KEY = 7240518300002;
+
+// Колонки задаються явно, щоб порядок колонок двох таблиць не мав значення
+const char* const TASK_COLUMNS =
+    "id, processing_type, status, created_at, completed_at, duration, image_id, "
+    "priority, started_at, trace_id, processed_path, output_options, worker_id, lease_expires_at, attempts";
+
+// Архівні секції лише доповнюються: щільні сторінки (fillfactor 100) і
+// стиснення текстових полів уже для рядків від 128 байт
+const char* const ARCHIVE_STORAGE = "WITH (fillfactor = 100, toast_tuple_target = 128)";
+
+}
+
+TaskRetention::TaskRetention(const DatabaseConfig& db_config, const RetentionConfig& retention_config)
+    : db_config(db_config), config(retention_config), stopping(false) {
+}
+
+TaskRetention::~TaskRetention() {
+    stop();
+}
+
+void TaskRetention::start() {
+    if (!config.enabled || worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    worker = std::thread(&TaskRetention::loop, this);
+}
+
+void TaskRetention::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void TaskRetention::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        runOnce();
+        lock.lock();
+        wake.wait_for(lock, std::chrono::seconds(config.interval_seconds), [this]() { return stopping; });
+    }
+    connection.reset();
+}
+
+void TaskRetention::runOnce() {
+    try {
+        if (!connection || !connection->is_open()) {
+            connection = std::make_unique<pqxx::connection>(db_config.getConnectionString());
+        }
+
+        {
+            pqxx::nontransaction txn(*connection);
+            pqxx::result locked = txn.exec_params("SELECT pg_try_advisory_lock($1)", RETENTION_LOCK_KEY);
+            if (!locked[0][0].as<bool>()) {
+                // Інший екземпляр уже обслуговує таблицю
+                return;
+            }
+        }
+
+        try {
+            ensurePartitions();
+            long long moved = archiveCompleted();
+            int dropped = dropEmptyPartitions();
+            if (moved > 0 || dropped > 0) {
+                std::cout << "Архівовано завдань: " << moved << ", видалено порожніх секцій: " << dropped << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Помилка обслуговування таблиці завдань: " << e.what() << std::endl;
+        }
+
+        pqxx::nontransaction txn(*connection);
+        txn.exec_params("SELECT pg_advisory_unlock($1)", RETENTION_LOCK_KEY);
+
+    } catch (const std::exception& e) {
+        // Втрачене з'єднання знімає і блокування; перепідключимося наступного разу
+        std::cerr << "Помилка з'єднання обслуговування завдань: " << e.what() << std::endl;
+        connection.reset();
+    }
+}
+
+// Секції поточного і наступних місяців для tasks та архівні секції для місяців,
+// з яких зараз будуть перенесені завдання
+void TaskRetention::ensurePartitions() {
+    pqxx::nontransaction txn(*connection);
+    try {
+        txn.exec_params(R"(
+            SELECT create_monthly_partition('tasks', (date_trunc('month', CURRENT_TIMESTAMP) + make_interval(months => g))::DATE)
+            FROM generate_series(0, $1) AS g
+        )", config.partitions_ahead);
+    } catch (const pqxx::sql_error& e) {
+        // Без секції DEFAULT вставка в місяць без секції падає, тож помилку видно в логах;
+        // архівування все одно продовжуємо
+        std::cerr << "Не вдалося створити секції завдань: " << e.what() << std::endl;
+    }
+
+    txn.exec_params(R"(
+        SELECT create_monthly_partition('tasks_archive', m::DATE, $2)
+        FROM (
+            SELECT DISTINCT date_trunc('month', created_at) AS m
+            FROM tasks
+            WHERE created_at < CURRENT_TIMESTAMP - make_interval(days => $1)
+              AND status IN ('completed', 'failed', 'dead')
+        ) months
+    )", config.retention_days, std::string(ARCHIVE_STORAGE));
+}
+
+// Перенесення пакетами: кожен пакет - коротка транзакція DELETE ... RETURNING -> INSERT
+long long TaskRetention::archiveCompleted() {
+    const std::string columns = TASK_COLUMNS;
+    const std::string sql =
+        "WITH moved AS ("
+        "    DELETE FROM tasks"
+        "    WHERE (id, created_at) IN ("
+        "        SELECT id, created_at FROM tasks"
+        "        WHERE created_at < CURRENT_TIMESTAMP - make_interval(days => $1)"
+        "          AND status IN ('completed', 'failed', 'dead')"
+        "        LIMIT $2)"
+        "    RETURNING " + columns +
+        ") INSERT INTO tasks_archive (" + columns + ") SELECT " + columns + " FROM moved";
+
+    long long total = 0;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                break;
+            }
+        }
+
+        pqxx::work txn(*connection);
+        txn.exec("SET LOCAL lock_timeout = '5s'");
+        pqxx::result result = txn.exec_params(sql, config.retention_days, config.batch_size);
+        txn.commit();
+
+        long long moved = result.affected_rows();
+        total += moved;
+        if (moved < config.batch_size) {
+            break;
+        }
+    }
+    return total;
+}
+
+// Старі секції tasks, з яких усе перенесено. Секції із завислими
+// pending/processing завданнями залишаються. DETACH ... CONCURRENTLY не бере
+// ACCESS EXCLUSIVE на tasks, тож взяття завдань і читання API не чекають;
+// він не може виконуватися в транзакції, тому кожна інструкція - окремий запит
+int TaskRetention::dropEmptyPartitions() {
+    struct Candidate {
+        std::string name;
+        bool detach_pending;
+    };
+    std::vector<Candidate> candidates;
+    {
+        pqxx::nontransaction txn(*connection);
+        pqxx::result result = txn.exec_params(R"(
+            SELECT c.relname, i.inhdetachpending
+            FROM pg_inherits i
+            JOIN pg_class c ON c.oid = i.inhrelid
+            WHERE i.inhparent = 'tasks'::regclass
+              AND c.relname ~ '^tasks_[0-9]{4}_[0-9]{2}$'
+              AND to_date(substr(c.relname, 7), 'YYYY_MM') + INTERVAL '1 month'
+                  <= CURRENT_TIMESTAMP - make_interval(days => $1)
+        )", config.retention_days);
+        for (const auto& row : result) {
+            candidates.push_back({row[0].as<std::string>(), row[1].as<bool>()});
+        }
+    }
+
+    int dropped = 0;
+    pqxx::nontransaction txn(*connection);
+    txn.exec("SET lock_timeout = '5s'");
+    for (const auto& candidate : candidates) {
+        std::string quoted = txn.quote_name(candidate.name);
+        try {
+            if (candidate.detach_pending) {
+                // Попередній DETACH CONCURRENTLY перервано - завершуємо його
+                txn.exec("ALTER TABLE tasks DETACH PARTITION " + quoted + " FINALIZE");
+            } else {
+                pqxx::result rows = txn.exec("SELECT EXISTS (SELECT 1 FROM " + quoted + ")");
+                if (rows[0][0].as<bool>()) {
+                    continue;
+                }
+                txn.exec("ALTER TABLE tasks DETACH PARTITION " + quoted + " CONCURRENTLY");
+            }
+
+            // Між перевіркою і від'єднанням могли з'явитися рядки - повертаємо секцію назад
+            pqxx::result rows = txn.exec("SELECT EXISTS (SELECT 1 FROM " + quoted + ")");
+            if (rows[0][0].as<bool>()) {
+                pqxx::result bounds = txn.exec_params(
+                    "SELECT to_date(substr($1, 7), 'YYYY_MM')::TEXT, "
+                    "(to_date(substr($1, 7), 'YYYY_MM') + INTERVAL '1 month')::DATE::TEXT",
+                    candidate.name);
+                txn.exec("ALTER TABLE tasks ATTACH PARTITION " + quoted + " FOR VALUES FROM (" +
+                         txn.quote(bounds[0][0].as<std::string>()) + ") TO (" +
+                         txn.quote(bounds[0][1].as<std::string>()) + ")");
+                continue;
+            }
+            txn.exec("DROP TABLE " + quoted);
+            ++dropped;
+        } catch (const pqxx::sql_error& e) {
+            std::cerr << "Не вдалося видалити секцію " << candidate.name << ": " << e.what() << std::endl;
+        }
+    }
+    txn.exec("RESET lock_timeout");
+    return dropped;
+}
@@ -0,0 +1,41 @@
+#ifndef TASK_RETENTION_H
+#define TASK_RETENTION_H
+
+#include <pqxx/pqxx>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "config/Config.h"
+
+// Фонове обслуговування секціонованої таблиці tasks: створює секції наперед,
+// переносить старі завершені завдання пакетами в tasks_archive і видаляє
+// спорожнілі старі секції. Працює на окремому з'єднанні; серед кількох
+// екземплярів сервера прохід виконує лише той, хто взяв advisory lock
+class TaskRetention {
+private:
+    DatabaseConfig db_config;
+    RetentionConfig config;
+    std::unique_ptr<pqxx::connection> connection;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void loop();
+    void runOnce();
+    void ensurePartitions();
+    long long archiveCompleted();
+    int dropEmptyPartitions();
+
+public:
+    TaskRetention(const DatabaseConfig& db_config, const RetentionConfig& retention_config);
+    ~TaskRetention();
+
+    void start();
+    void stop();
+};
+
+#endif
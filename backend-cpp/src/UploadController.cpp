@@ -0,0 +1,309 @@
+#include "UploadController.h"
+#include "ImageController.h"
+#include "tracing/Tracer.h"
+#include "middleware/BodyLimit.h"
+#include <iostream>
+#include <openssl/rand.h>
+#include <stdexcept>
+
+UploadController::UploadController(DatabaseManager& db, R2Manager& r2_manager,
+                                   const UploadSessionConfig& upload_config)
+    : db_manager(db), r2_manager(r2_manager), config(upload_config) {
+}
+
+std::string UploadController::generateToken() {
+    // 128 біт з криптографічного генератора - ID сесії є єдиним ключем доступу до неї
+    unsigned char bytes[16];
+    if (RAND_bytes(bytes, sizeof(bytes)) != 1) {
+        throw std::runtime_error("Не вдалося згенерувати ID сесії");
+    }
+    static const char hex[] = "0123456789abcdef";
+    std::string id;
+    id.reserve(sizeof(bytes) * 2);
+    for (unsigned char byte : bytes) {
+        id += hex[byte >> 4];
+        id += hex[byte & 0x0f];
+    }
+    return id;
+}
+
+void UploadController::setOffsetHeaders(crow::response& res, const UploadSession& session) {
+    res.set_header("Tus-Resumable", "1.0.0");
+    res.set_header("Upload-Offset", std::to_string(session.upload_offset));
+    res.set_header("Upload-Length", std::to_string(session.total_size));
+    res.set_header("Cache-Control", "no-store");
+}
+
+// Створення сесії: запис зображення, multipart завантаження в R2 та стан у Postgres
+crow::response UploadController::createSession(const crow::request& req) {
+    std::cout << "=== Створення сесії завантаження ===" << std::endl;
+    try {
+        crow::multipart::message msg(req);
+
+        std::string name = msg.get_part_by_name("name").body;
+        std::string description = msg.get_part_by_name("description").body;
+        std::string filename = msg.get_part_by_name("filename").body;
+        std::string size_str = msg.get_part_by_name("size").body;
+
+        if (filename.empty()) {
+            return crow::response(400, "Ім'я файлу не надано");
+        }
+        if (!ImageController::isValidImageFormat(filename)) {
+            return crow::response(400, "Невірний формат зображення");
+        }
+
+        long long total_size = 0;
+        try {
+            total_size = std::stoll(size_str);
+        } catch (const std::exception&) {
+            return crow::response(400, "Невірний розмір файлу");
+        }
+        if (total_size <= 0) {
+            return crow::response(400, "Невірний розмір файлу");
+        }
+
+        Image new_image(name, description, filename, "", "", ImageStatus::AwaitingUpload);
+        new_image.size_bytes = total_size;
+        int image_id = db_manager.createImage(new_image);
+        if (image_id == -1) {
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        UploadSession session;
+        session.id = generateToken();
+        session.image_id = image_id;
+        session.object_key = r2_manager.getOriginalKey(filename, image_id);
+        session.total_size = total_size;
+        session.part_size = r2_manager.getMultipartPartSize();
+
+        {
+            tracing::Span r2_span("r2.createMultipartUpload");
+            session.r2_upload_id = r2_manager.createMultipartUpload(session.object_key);
+        }
+        if (session.r2_upload_id.empty()) {
+            db_manager.updateImageStatus(image_id, ImageStatus::Error, "Не вдалося почати завантаження");
+            return crow::response(502, "Помилка сховища");
+        }
+
+        if (!db_manager.createUploadSession(session)) {
+            r2_manager.abortMultipartUpload(session.object_key, session.r2_upload_id);
+            db_manager.updateImageStatus(image_id, ImageStatus::Error, "Не вдалося почати завантаження");
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        std::cout << "Сесія " << session.id << " для зображення " << image_id << std::endl;
+
+        crow::json::wvalue response;
+        response["id"] = session.id;
+        response["image_id"] = image_id;
+        response["part_size"] = session.part_size;
+        response["upload_offset"] = 0;
+        response["upload_length"] = total_size;
+
+        crow::response res(201, response);
+        res.set_header("Location", "/api/uploads/" + session.id);
+        setOffsetHeaders(res, session);
+        return res;
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Поточний стан сесії (HEAD повертає лише заголовки)
+crow::response UploadController::getSession(const crow::request& req, const std::string& id) {
+    try {
+        UploadSession session = db_manager.getUploadSession(id);
+        if (session.id.empty()) {
+            return crow::response(404, "Сесію завантаження не знайдено");
+        }
+
+        crow::json::wvalue response;
+        response["id"] = session.id;
+        response["image_id"] = session.image_id;
+        response["part_size"] = session.part_size;
+        response["upload_offset"] = session.upload_offset;
+        response["upload_length"] = session.total_size;
+        response["status"] = session.status;
+
+        crow::response res(200, response);
+        setOffsetHeaders(res, session);
+        return res;
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Прийом частини за зміщенням. Кожна частина одразу відправляється в R2 як
+// part multipart завантаження, тому вже підтверджені байти ніколи не надсилаються повторно
+crow::response UploadController::uploadChunk(const crow::request& req, const std::string& id) {
+    try {
+        UploadSession session = db_manager.getUploadSession(id);
+        if (session.id.empty()) {
+            return crow::response(404, "Сесію завантаження не знайдено");
+        }
+        if (session.status != "active") {
+            return crow::response(410, "Сесія завантаження завершена");
+        }
+
+        long long offset = -1;
+        try {
+            offset = std::stoll(req.get_header_value("Upload-Offset"));
+        } catch (const std::exception&) {
+            return crow::response(400, "Заголовок Upload-Offset обов'язковий");
+        }
+
+        // Клієнт має продовжувати з підтвердженого зміщення
+        if (offset != session.upload_offset) {
+            crow::response res(409, "Невірне зміщення");
+            setOffsetHeaders(res, session);
+            return res;
+        }
+
+        std::string_view chunk = BodyLimit::body(req);
+        long long chunk_size = static_cast<long long>(chunk.size());
+        long long end = offset + chunk_size;
+        if (chunk_size == 0 || end > session.total_size) {
+            return crow::response(400, "Невірний розмір частини");
+        }
+        // R2 вимагає однаковий розмір усіх частин, крім останньої
+        if (chunk_size != session.part_size && end != session.total_size) {
+            crow::response res(400, "Розмір частини має дорівнювати " + std::to_string(session.part_size));
+            setOffsetHeaders(res, session);
+            return res;
+        }
+
+        // Зміщення утримується до завантаження в R2: паралельний запит на те саме
+        // зміщення отримує 409, а не завантажує ту саму частину вдруге
+        std::string claim = generateToken();
+        if (!db_manager.claimUploadOffset(session.id, offset, claim, config.claim_seconds)) {
+            UploadSession current = db_manager.getUploadSession(id);
+            crow::response res(409, "Частина з цим зміщенням вже завантажується");
+            if (!current.id.empty()) {
+                setOffsetHeaders(res, current);
+            }
+            return res;
+        }
+
+        int part_number = static_cast<int>(offset / session.part_size) + 1;
+        std::string etag;
+        {
+            tracing::Span r2_span("r2.uploadPart");
+            r2_span.setAttribute("part.size", chunk_size);
+            etag = r2_manager.uploadPart(session.object_key, session.r2_upload_id, part_number, chunk);
+        }
+        if (etag.empty()) {
+            db_manager.releaseUploadClaim(session.id, claim);
+            return crow::response(502, "Помилка завантаження частини в сховище");
+        }
+
+        if (!db_manager.recordUploadPart(session.id, claim, part_number, etag, chunk_size, offset, end)) {
+            // Утримання прострочилося і його перехопив інший запит, або сесію скасовано
+            UploadSession current = db_manager.getUploadSession(id);
+            crow::response res(409, "Невірне зміщення");
+            if (!current.id.empty()) {
+                setOffsetHeaders(res, current);
+            }
+            return res;
+        }
+
+        session.upload_offset = end;
+        crow::response res(204);
+        setOffsetHeaders(res, session);
+        return res;
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Завершення: збирання частин у R2 та позначення зображення як завантаженого
+crow::response UploadController::completeSession(const crow::request& req, const std::string& id) {
+    try {
+        UploadSession session = db_manager.getUploadSession(id);
+        if (session.id.empty()) {
+            return crow::response(404, "Сесію завантаження не знайдено");
+        }
+
+        crow::json::wvalue response;
+        response["id"] = session.id;
+        response["image_id"] = session.image_id;
+
+        if (session.status == "completed") {
+            response["status"] = "uploaded";
+            return crow::response(200, response);
+        }
+        if (session.status == "completing") {
+            return crow::response(409, "Завантаження вже завершується");
+        }
+        if (session.status != "active") {
+            return crow::response(410, "Сесія завантаження скасована");
+        }
+        if (session.upload_offset != session.total_size) {
+            crow::response res(409, "Завантаження ще не завершене");
+            setOffsetHeaders(res, session);
+            return res;
+        }
+
+        auto parts = db_manager.getUploadParts(session.id);
+        if (parts.empty()) {
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        // Спершу умовний перехід у "completing": паралельне завершення, скасування
+        // чи прибирання сесії після цього вже не застосуються, тож R2 викликається один раз
+        if (!db_manager.transitionUploadSession(session.id, "active", "completing")) {
+            return crow::response(409, "Стан сесії завантаження змінився");
+        }
+
+        bool completed;
+        {
+            tracing::Span r2_span("r2.completeMultipartUpload");
+            completed = r2_manager.completeMultipartUpload(session.object_key, session.r2_upload_id, parts);
+        }
+        if (!completed) {
+            // Повертаємо сесію, щоб клієнт міг повторити завершення
+            db_manager.transitionUploadSession(session.id, "completing", "active");
+            return crow::response(502, "Помилка завершення завантаження в сховищі");
+        }
+
+        if (!db_manager.transitionUploadSession(session.id, "completing", "completed") ||
+            !db_manager.updateImageStatus(session.image_id, ImageStatus::Uploaded, "")) {
+            return crow::response(500, "Помилка бази даних");
+        }
+
+        response["status"] = "uploaded";
+        return crow::response(200, response);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
+
+// Скасування сесії та multipart завантаження в R2
+crow::response UploadController::abortSession(const crow::request& req, const std::string& id) {
+    try {
+        UploadSession session = db_manager.getUploadSession(id);
+        if (session.id.empty()) {
+            return crow::response(404, "Сесію завантаження не знайдено");
+        }
+        if (session.status != "active") {
+            return crow::response(410, "Сесія завантаження завершена");
+        }
+
+        // Скасування застосовується лише до активної сесії без частини в процесі
+        // завантаження; R2 викликається тільки після успішного переходу
+        if (!db_manager.transitionUploadSession(session.id, "active", "aborted")) {
+            return crow::response(409, "Стан сесії завантаження змінився");
+        }
+
+        r2_manager.abortMultipartUpload(session.object_key, session.r2_upload_id);
+        db_manager.updateImageStatus(session.image_id, ImageStatus::Error, "Завантаження скасоване");
+
+        return crow::response(204);
+
+    } catch (const std::exception& e) {
+        return crow::response(500, std::string("Помилка: ") + e.what());
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef UPLOAD_CONTROLLER_H
+#define UPLOAD_CONTROLLER_H
+
+#include "crow.h"
+#include "DatabaseManager.h"
+#include "R2Manager.h"
+#include "models/UploadSession.h"
+#include <string>
+
+// Відновлювані завантаження частинами (протокол у стилі tus):
+// створення сесії, PATCH частин за зміщенням, завершення
+class UploadController {
+private:
+    DatabaseManager& db_manager;
+    R2Manager& r2_manager;
+    UploadSessionConfig config;
+
+    // 128-бітний випадковий hex токен: ID сесії та утримання зміщення
+    std::string generateToken();
+    void setOffsetHeaders(crow::response& res, const UploadSession& session);
+
+public:
+    UploadController(DatabaseManager& db , R2Manager& r2_manager, const UploadSessionConfig& upload_config);
+    crow::response createSession(const crow::request& req);
+    crow::response getSession(const crow::request& req, const std::string& id);
+    crow::response uploadChunk(const crow::request& req, const std::string& id);
+    crow::response completeSession(const crow::request& req, const std::string& id);
+    crow::response abortSession(const crow::request& req, const std::string& id);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "UploadSessionSweeper.h"
+#include <chrono>
+#include <iostream>
+
+UploadSessionSweeper::UploadSessionSweeper(DatabaseManager& db, R2Manager& r2_manager,
+                                           const UploadSessionConfig& upload_config)
+    : db_manager(db), r2_manager(r2_manager), config(upload_config), stopping(false) {
+}
+
+UploadSessionSweeper::~UploadSessionSweeper() {
+    stop();
+}
+
+void UploadSessionSweeper::start() {
+    if (!config.sweep_enabled || worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    worker = std::thread(&UploadSessionSweeper::loop, this);
+}
+
+void UploadSessionSweeper::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void UploadSessionSweeper::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        runOnce();
+        lock.lock();
+        wake.wait_for(lock, std::chrono::seconds(config.sweep_interval_seconds), [this]() { return stopping; });
+    }
+}
+
+// Пакетами, доки є прострочені сесії; сесія вже "aborted" в базі до звернення
+// до R2, тож нові частини для неї не приймаються
+void UploadSessionSweeper::runOnce() {
+    int expired = 0;
+    while (true) {
+        std::vector<UploadSession> sessions =
+            db_manager.expireUploadSessions(config.session_ttl_seconds, config.sweep_batch_size);
+        for (const auto& session : sessions) {
+            if (!r2_manager.abortMultipartUpload(session.object_key, session.r2_upload_id)) {
+                std::cerr << "Не вдалося скасувати multipart завантаження " << session.object_key << std::endl;
+            }
+            db_manager.updateImageStatus(session.image_id, ImageStatus::Error, "Завантаження прострочене");
+        }
+        expired += static_cast<int>(sessions.size());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || static_cast<int>(sessions.size()) < config.sweep_batch_size) {
+            break;
+        }
+    }
+    if (expired > 0) {
+        std::cout << "Скасовано покинутих сесій завантаження: " << expired << std::endl;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef UPLOAD_SESSION_SWEEPER_H
+#define UPLOAD_SESSION_SWEEPER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "DatabaseManager.h"
+#include "R2Manager.h"
+#include "config/Config.h"
+
+// Фонове скасування покинутих сесій завантаження частинами: сесія без нових
+// частин довше за session_ttl_seconds переходить у "aborted", її multipart
+// завантаження в R2 скасовується (інакше вже завантажені частини лишаються
+// в сховищі), а зображення отримує статус помилки
+class UploadSessionSweeper {
+private:
+    DatabaseManager& db_manager;
+    R2Manager& r2_manager;
+    UploadSessionConfig config;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void loop();
+    void runOnce();
+
+public:
+    UploadSessionSweeper(DatabaseManager& db, R2Manager& r2_manager, const UploadSessionConfig& upload_config);
+    ~UploadSessionSweeper();
+
+    void start();
+    void stop();
+};
+
+#endif
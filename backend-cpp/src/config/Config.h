@@ -4,6 +4,8 @@
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
 
 //Database  config
 struct DatabaseConfig {
@@ -13,10 +15,28 @@ struct DatabaseConfig {
     std::string name = "image_processor";
     std::string user = "postgres";
     std::string password = "password";
+
+    // репліки для читання (streaming replication), ті ж dbname/user/password
+    struct ReplicaHost {
+        std::string host;
+        std::string port;
+    };
+    std::vector<ReplicaHost> replica_hosts;
+    // репліка з більшим відставанням не використовується
+    long long replica_max_lag_ms = 1000;
+    // після запису клієнта його читання йдуть на primary протягом цього часу
+    long long read_your_writes_ms = 5000;
+    int replica_check_interval_ms = 1000;
+    // з'єднань до primary (0 - за кількістю потоків виконавця, див. main)
+    int pool_size = 0;
     
     std::string getConnectionString() const {
-        return "host=" + host + 
-               " port=" + port + 
+        return getConnectionString(host, port);
+    }
+
+    std::string getConnectionString(const std::string& target_host, const std::string& target_port) const {
+        return "host=" + target_host + 
+               " port=" + target_port + 
                " dbname=" + name + 
                " user=" + user + 
                " password=" + password;
@@ -28,6 +48,54 @@ struct DatabaseConfig {
         if (const char* env_user = std::getenv("DB_USER")) user = env_user;
         if (const char* env_password = std::getenv("DB_PASSWORD")) password = env_password;
         if (const char* env_name = std::getenv("DB_NAME")) name = env_name;
+        // DB_REPLICA_HOSTS=host1:5432,host2 (порт за замовчуванням як у primary)
+        if (const char* env_replicas = std::getenv("DB_REPLICA_HOSTS")) {
+            std::string list = env_replicas;
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) end = list.size();
+                std::string item = list.substr(start, end - start);
+                item.erase(0, item.find_first_not_of(' '));
+                item.erase(item.find_last_not_of(' ') + 1);
+                if (!item.empty()) {
+                    size_t colon = item.find(':');
+                    if (colon == std::string::npos) {
+                        replica_hosts.push_back({item, port});
+                    } else {
+                        replica_hosts.push_back({item.substr(0, colon), item.substr(colon + 1)});
+                    }
+                }
+                start = end + 1;
+            }
+        }
+        if (const char* env_pool = std::getenv("DB_POOL_SIZE")) {
+            try {
+                pool_size = std::max(0, std::stoi(env_pool));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid DB_POOL_SIZE environment variable. Using default: " << pool_size << std::endl;
+            }
+        }
+        readLong("DB_REPLICA_MAX_LAG_MS", replica_max_lag_ms);
+        readLong("DB_READ_YOUR_WRITES_MS", read_your_writes_ms);
+        if (const char* env_interval = std::getenv("DB_REPLICA_CHECK_INTERVAL_MS")) {
+            try {
+                replica_check_interval_ms = std::max(100, std::stoi(env_interval));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid DB_REPLICA_CHECK_INTERVAL_MS environment variable. Using default: " << replica_check_interval_ms << std::endl;
+            }
+        }
+    }
+
+private:
+    static void readLong(const char* name, long long& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stoll(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
     }
 };
 
@@ -35,6 +103,15 @@ struct DatabaseConfig {
 //ServerConfig
 struct ServerConfig {
     int port = 8080;
+    // потоки Crow для I/O (0 - кількість ядер)
+    int io_threads = 0;
+    // потоки виконавця для блокуючих запитів до бази та R2 (0 - 2 x кількість ядер)
+    int executor_threads = 0;
+    // прив'язка до ядер, напр. "0-3" або "0,2,4" (порожньо - без прив'язки)
+    std::vector<int> io_cpus;
+    std::vector<int> executor_cpus;
+    // довірені проксі (адреси або CIDR через кому); X-Forwarded-For від інших ігнорується
+    std::string trusted_proxies;
     
     ServerConfig() {
         if (const char* env_port = std::getenv("PORT")) {
@@ -44,6 +121,47 @@ struct ServerConfig {
                 std::cerr << "Warning: Invalid PORT environment variable. Using default: " << port << std::endl;
             }
         }
+        readInt("SERVER_IO_THREADS", io_threads);
+        readInt("SERVER_EXECUTOR_THREADS", executor_threads);
+        if (const char* env_cpus = std::getenv("SERVER_IO_CPUS")) io_cpus = parseCpuList(env_cpus);
+        if (const char* env_cpus = std::getenv("SERVER_EXECUTOR_CPUS")) executor_cpus = parseCpuList(env_cpus);
+        if (const char* env_proxies = std::getenv("TRUSTED_PROXIES")) trusted_proxies = env_proxies;
+    }
+
+private:
+    static void readInt(const char* name, int& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::max(0, std::stoi(env));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        size_t start = 0;
+        try {
+            while (start < list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) end = list.size();
+                std::string item = list.substr(start, end - start);
+                size_t dash = item.find('-');
+                if (dash == std::string::npos) {
+                    cpus.push_back(std::stoi(item));
+                } else {
+                    int first = std::stoi(item.substr(0, dash));
+                    int last = std::stoi(item.substr(dash + 1));
+                    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+                }
+                start = end + 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Invalid CPU list '" << list << "'. Affinity disabled" << std::endl;
+            cpus.clear();
+        }
+        return cpus;
     }
 };
 
@@ -55,12 +173,284 @@ struct R2Config {
     std::string secret_key;
     std::string endpoint;
     std::string public_url  = "https://senchuknazar123.online";
+    // час життя підписаних URL для прямого завантаження (секунди)
+    long long presign_expiry_seconds = 900;
+    // локальний дисковий кеш об'єктів
+    std::string cache_dir = "/tmp/r2-cache";
+    unsigned long long cache_max_bytes = 1024ULL * 1024 * 1024;
+    // розмір частини multipart завантаження (R2: мінімум 5 МБ, усі частини
+    // крім останньої однакового розміру)
+    long long multipart_part_size = 8LL * 1024 * 1024;
 
     R2Config() {
         if (const char* env_bucket = std::getenv("R2_BUCKET_NAME")) bucket_name = env_bucket;
         if (const char* env_access = std::getenv("R2_ACCESS_KEY")) access_key = env_access;
         if (const char* env_secret = std::getenv("R2_SECRET_KEY")) secret_key = env_secret;
         if (const char* env_endpoint = std::getenv("R2_ENDPOINT")) endpoint = env_endpoint;
+        if (const char* env_expiry = std::getenv("R2_PRESIGN_EXPIRY")) {
+            try {
+                presign_expiry_seconds = std::stoll(env_expiry);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid R2_PRESIGN_EXPIRY environment variable. Using default: " << presign_expiry_seconds << std::endl;
+            }
+        }
+        if (const char* env_cache_dir = std::getenv("R2_CACHE_DIR")) cache_dir = env_cache_dir;
+        if (const char* env_cache_max = std::getenv("R2_CACHE_MAX_BYTES")) {
+            try {
+                cache_max_bytes = std::stoull(env_cache_max);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid R2_CACHE_MAX_BYTES environment variable. Using default: " << cache_max_bytes << std::endl;
+            }
+        }
+        if (const char* env_part_size = std::getenv("R2_MULTIPART_PART_SIZE")) {
+            try {
+                multipart_part_size = std::max(5LL * 1024 * 1024, std::stoll(env_part_size));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid R2_MULTIPART_PART_SIZE environment variable. Using default: " << multipart_part_size << std::endl;
+            }
+        }
+    }
+};
+
+//AdmissionConfig - обмеження навантаження на сервер
+struct AdmissionConfig {
+    bool enabled = true;
+    // token bucket на клієнта
+    double client_rate = 20.0;      // запитів за секунду
+    double client_burst = 40.0;
+    // адаптивні ліміти паралельності (AIMD) для класів маршрутів
+    int upload_min_concurrency = 2;
+    int upload_max_concurrency = 16;
+    int upload_target_latency_ms = 5000;   // на upload_latency_unit_kb тіла
+    int upload_latency_unit_kb = 1024;     // більші тіла порівнюються з ціллю пропорційно
+    int read_min_concurrency = 8;
+    int read_max_concurrency = 128;
+    int read_target_latency_ms = 300;
+
+    AdmissionConfig() {
+        if (const char* env_enabled = std::getenv("ADMISSION_ENABLED")) {
+            std::string value = env_enabled;
+            enabled = !(value == "0" || value == "false");
+        }
+        readDouble("ADMISSION_CLIENT_RATE", client_rate);
+        readDouble("ADMISSION_CLIENT_BURST", client_burst);
+        readInt("ADMISSION_UPLOAD_MAX_CONCURRENCY", upload_max_concurrency);
+        readInt("ADMISSION_UPLOAD_TARGET_MS", upload_target_latency_ms);
+        readInt("ADMISSION_UPLOAD_LATENCY_UNIT_KB", upload_latency_unit_kb);
+        upload_latency_unit_kb = std::max(1, upload_latency_unit_kb);
+        readInt("ADMISSION_READ_MAX_CONCURRENCY", read_max_concurrency);
+        readInt("ADMISSION_READ_TARGET_MS", read_target_latency_ms);
+    }
+
+private:
+    static void readInt(const char* name, int& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stoi(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+    static void readDouble(const char* name, double& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stod(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+};
+
+//UploadSessionConfig - завантаження частинами: утримання зміщення та скасування покинутих сесій
+struct UploadSessionConfig {
+    int claim_seconds = 300;             // скільки частина може завантажуватися в R2 до втрати зміщення
+    bool sweep_enabled = true;
+    int session_ttl_seconds = 24 * 3600; // активні сесії без нових частин довше - скасовуються
+    int sweep_interval_seconds = 600;
+    int sweep_batch_size = 100;
+
+    UploadSessionConfig() {
+        if (const char* env_enabled = std::getenv("UPLOAD_SWEEP_ENABLED")) {
+            std::string value = env_enabled;
+            sweep_enabled = !(value == "0" || value == "false");
+        }
+        readInt("UPLOAD_CLAIM_SECONDS", claim_seconds);
+        readInt("UPLOAD_SESSION_TTL_SECONDS", session_ttl_seconds);
+        readInt("UPLOAD_SWEEP_INTERVAL_SECONDS", sweep_interval_seconds);
+        readInt("UPLOAD_SWEEP_BATCH_SIZE", sweep_batch_size);
+        claim_seconds = std::max(60, claim_seconds);
+        // Сесія не може вважатися покинутою, поки її частина ще може завантажуватися
+        session_ttl_seconds = std::max(claim_seconds, session_ttl_seconds);
+        sweep_interval_seconds = std::max(60, sweep_interval_seconds);
+        sweep_batch_size = std::max(1, sweep_batch_size);
+    }
+
+private:
+    static void readInt(const char* name, int& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stoi(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+};
+
+//BodyLimitConfig - обмеження пам'яті під тіла запитів (завантаження файлів)
+struct BodyLimitConfig {
+    long long max_body_bytes = 100LL * 1024 * 1024;         // більші тіла - 413
+    long long inflight_budget_bytes = 512LL * 1024 * 1024;  // сума тіл запитів в обробці
+    long long spool_threshold_bytes = 4LL * 1024 * 1024;    // більші тіла завантажень - у тимчасовий файл
+    std::string spool_dir = "/tmp";
+
+    BodyLimitConfig() {
+        if (const char* env_tmp = std::getenv("TMPDIR")) spool_dir = env_tmp;
+        if (const char* env_dir = std::getenv("UPLOAD_SPOOL_DIR")) spool_dir = env_dir;
+        readLongLong("UPLOAD_MAX_BODY_BYTES", max_body_bytes);
+        readLongLong("UPLOAD_INFLIGHT_BUDGET_BYTES", inflight_budget_bytes);
+        readLongLong("UPLOAD_SPOOL_THRESHOLD_BYTES", spool_threshold_bytes);
+        // Одне максимальне тіло завжди має вміщатися в бюджет
+        inflight_budget_bytes = std::max(inflight_budget_bytes, max_body_bytes);
+    }
+
+private:
+    static void readLongLong(const char* name, long long& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::max(0LL, std::stoll(env));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+};
+
+//RetentionConfig - перенесення завершених завдань в архів
+struct RetentionConfig {
+    bool enabled = true;
+    int retention_days = 30;        // завершені завдання, старші за це, йдуть в tasks_archive
+    int interval_seconds = 3600;
+    int batch_size = 5000;          // рядків за одну транзакцію перенесення
+    int partitions_ahead = 2;       // скільки наступних місяців секцій створювати заздалегідь
+
+    RetentionConfig() {
+        if (const char* env_enabled = std::getenv("TASK_RETENTION_ENABLED")) {
+            std::string value = env_enabled;
+            enabled = !(value == "0" || value == "false");
+        }
+        readInt("TASK_RETENTION_DAYS", retention_days);
+        readInt("TASK_RETENTION_INTERVAL_SECONDS", interval_seconds);
+        readInt("TASK_RETENTION_BATCH_SIZE", batch_size);
+        retention_days = std::max(1, retention_days);
+        interval_seconds = std::max(60, interval_seconds);
+        batch_size = std::max(1, batch_size);
+    }
+
+private:
+    static void readInt(const char* name, int& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stoi(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+};
+
+//SimilarityConfig - індекс перцептивних хешів для пошуку схожих зображень
+struct SimilarityConfig {
+    bool enabled = true;
+    int poll_interval_seconds = 5;   // як часто підхоплювати нові хеші з бази
+    int default_max_distance = 8;    // відстань Хеммінга за замовчуванням
+
+    SimilarityConfig() {
+        if (const char* env_enabled = std::getenv("SIMILARITY_ENABLED")) {
+            std::string value = env_enabled;
+            enabled = !(value == "0" || value == "false");
+        }
+        if (const char* env_interval = std::getenv("SIMILARITY_POLL_INTERVAL")) {
+            try {
+                poll_interval_seconds = std::max(1, std::stoi(env_interval));
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid SIMILARITY_POLL_INTERVAL environment variable. Using default: " << poll_interval_seconds << std::endl;
+            }
+        }
+    }
+};
+
+//RecorderConfig - запис вхідних запитів для відтворення навантаження (tools/replay)
+struct RecorderConfig {
+    bool enabled = false;
+    std::string output_path = "requests.rec";
+    // частка запитів, тіло яких зберігається як є (решта - лише розмір,
+    // replay підставляє синтетичне тіло того ж розміру)
+    double body_sample_rate = 0.0;
+    int max_body_bytes = 1024 * 1024;       // більші тіла ніколи не зберігаються
+    int small_body_bytes = 4096;            // форми завдань і сесій зберігаються завжди
+    int buffer_bytes = 64 * 1024 * 1024;    // якщо запис не встигає, записи відкидаються
+    int flush_interval_ms = 1000;
+
+    RecorderConfig() {
+        if (const char* env_enabled = std::getenv("RECORDER_ENABLED")) {
+            std::string value = env_enabled;
+            enabled = value == "1" || value == "true";
+        }
+        if (const char* env_path = std::getenv("RECORDER_FILE")) output_path = env_path;
+        readDouble("RECORDER_BODY_SAMPLE_RATE", body_sample_rate);
+        readInt("RECORDER_MAX_BODY_BYTES", max_body_bytes);
+        readInt("RECORDER_SMALL_BODY_BYTES", small_body_bytes);
+        readInt("RECORDER_BUFFER_BYTES", buffer_bytes);
+        body_sample_rate = std::min(1.0, std::max(0.0, body_sample_rate));
+        small_body_bytes = std::min(small_body_bytes, max_body_bytes);
+    }
+
+private:
+    static void readInt(const char* name, int& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stoi(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+    static void readDouble(const char* name, double& value) {
+        if (const char* env = std::getenv(name)) {
+            try {
+                value = std::stod(env);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid " << name << " environment variable. Using default: " << value << std::endl;
+            }
+        }
+    }
+};
+
+//TracingConfig
+struct TracingConfig {
+    bool enabled = false;
+    std::string output_path = "traces.jsonl";
+    std::string service_name = "backend-cpp";
+    size_t buffer_size = 8192;      // кількість спанів у кільцевому буфері
+    int flush_interval_ms = 1000;
+
+    TracingConfig() {
+        if (const char* env_enabled = std::getenv("TRACING_ENABLED")) {
+            std::string value = env_enabled;
+            enabled = value == "1" || value == "true";
+        }
+        if (const char* env_path = std::getenv("TRACING_FILE")) output_path = env_path;
+        if (const char* env_service = std::getenv("TRACING_SERVICE_NAME")) service_name = env_service;
+        if (const char* env_buffer = std::getenv("TRACING_BUFFER_SIZE")) {
+            try {
+                buffer_size = std::stoul(env_buffer);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Invalid TRACING_BUFFER_SIZE environment variable. Using default: " << buffer_size << std::endl;
+            }
+        }
     }
 };
 
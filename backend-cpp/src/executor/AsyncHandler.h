@@ -0,0 +1,44 @@
+#ifndef ASYNC_HANDLER_H
+#define ASYNC_HANDLER_H
+
+#include "crow.h"
+#include "Executor.h"
+#include "../DatabaseManager.h"
+#include "../tracing/Tracer.h"
+#include <exception>
+#include <string>
+#include <utility>
+
+// Виконує обробник у виконавці, а I/O потік Crow одразу повертається до
+// інших з'єднань. Запит чекає, доки res.end() не буде викликано з виконавця
+// (Crow тримає з'єднання, а отже req і res, до завершення відповіді).
+// Контекст трасування і клієнт read-your-writes переносяться у потік виконавця:
+// там працюють спани обробника і after_handle middleware, що закриває спан запиту
+template <typename Handler>
+void runAsync(Executor& executor, const crow::request& req, crow::response& res, Handler handler) {
+    // Контекст запиту і клієнт переходять у завдання, I/O потік не лишає їх собі
+    // для наступних з'єднань
+    tracing::SpanContext trace = tracing::Tracer::current();
+    tracing::Tracer::setCurrent(tracing::SpanContext{});
+    std::string client = DatabaseManager::ClientScope::release();
+
+    executor.submit([&req, &res, trace, client = std::move(client), handler = std::move(handler)]() mutable {
+        tracing::ScopedContext trace_scope(trace);
+        DatabaseManager::ClientScope client_scope(client);
+
+        // Клієнт уже відключився - блокуючу роботу не виконуємо
+        if (!res.is_alive()) {
+            res.end();
+            return;
+        }
+
+        try {
+            res = handler(req);
+        } catch (const std::exception& e) {
+            res = crow::response(500, std::string("Помилка: ") + e.what());
+        }
+        res.end();
+    });
+}
+
+#endif
@@ -0,0 +1,26 @@
+#include "CpuAffinity.h"
+#include <iostream>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+bool setCurrentThreadAffinity(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        std::cerr << "Не вдалося встановити прив'язку до ядер: " << std::strerror(result) << std::endl;
+        return false;
+    }
+    return true;
+}
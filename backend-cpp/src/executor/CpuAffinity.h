@@ -0,0 +1,10 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <vector>
+
+// Прив'язка поточного потоку до ядер. Потоки, створені після виклику,
+// успадковують прив'язку (так задається прив'язка I/O потоків Crow)
+bool setCurrentThreadAffinity(const std::vector<int>& cpus);
+
+#endif
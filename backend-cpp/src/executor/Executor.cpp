@@ -0,0 +1,149 @@
+#include "Executor.h"
+#include "CpuAffinity.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <exception>
+
+namespace {
+
+// Виконавець і черга поточного потоку (nullptr поза потоками виконавця)
+thread_local Executor* current_executor = nullptr;
+thread_local size_t current_index = 0;
+
+// Відступ вільного потоку, коли завдання є, але взяти його не вдалося
+constexpr size_t SPIN_LIMIT = 16;
+constexpr size_t MAX_BACKOFF_SHIFT = 6;
+constexpr std::chrono::microseconds MIN_BACKOFF{20};
+
+void execute(std::function<void()>& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка завдання виконавця: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Невідома помилка завдання виконавця" << std::endl;
+    }
+}
+
+}
+
+Executor::Executor(size_t thread_count, const std::vector<int>& cpus)
+    : next_queue(0), pending(0), stopping(false) {
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back(&Executor::run, this, i, cpus);
+    }
+}
+
+Executor::~Executor() {
+    stop();
+}
+
+void Executor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void Executor::submit(std::function<void()> task) {
+    // Завдання з потоку виконавця лишається в його черзі (гаряча кеш-лінія),
+    // зовнішні розподіляються по чергах по колу
+    size_t index = current_executor == this
+        ? current_index
+        : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        // Під sleep_mutex, щоб потік не пропустив пробудження між перевіркою і очікуванням
+        // і не завершився, поки завдання ще не в черзі
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        if (stopping) {
+            // Після stop() потоки можуть уже завершитися - виконуємо в потоці виклику
+            lock.unlock();
+            execute(task);
+            return;
+        }
+        pending.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+bool Executor::popLocal(size_t index, std::function<void()>& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool Executor::steal(size_t index, std::function<void()>& task) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& queue = *queues[(index + offset) % queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void Executor::run(size_t index, const std::vector<int>& cpus) {
+    setCurrentThreadAffinity(cpus);
+    current_executor = this;
+    current_index = index;
+
+    std::function<void()> task;
+    size_t misses = 0;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            misses = 0;
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            execute(task);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        if (stopping && pending.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+        if (pending.load(std::memory_order_acquire) > 0) {
+            // Завдання є, але його черга зайнята власником або його щойно забрали:
+            // wait() тут повернувся б одразу, тож відступаємо замість холостого циклу
+            lock.unlock();
+            if (++misses <= SPIN_LIMIT) {
+                std::this_thread::yield();
+            } else {
+                size_t shift = std::min<size_t>(misses - SPIN_LIMIT, MAX_BACKOFF_SHIFT);
+                std::this_thread::sleep_for(MIN_BACKOFF * (1 << shift));
+            }
+            continue;
+        }
+        misses = 0;
+        wake.wait(lock, [this]() { return stopping || pending.load(std::memory_order_acquire) > 0; });
+    }
+
+    current_executor = nullptr;
+}
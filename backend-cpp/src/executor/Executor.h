@@ -0,0 +1,52 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоків з викраденням роботи для блокуючих операцій (libpqxx, AWS SDK),
+// щоб вони не займали I/O потоки Crow. Кожен потік має власну чергу: нові
+// завдання від свого потоку беруться з кінця (LIFO), вільні потоки крадуть
+// найстаріші завдання з початку чужих черг
+class Executor {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next_queue;
+    std::atomic<size_t> pending;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    bool popLocal(size_t index, std::function<void()>& task);
+    bool steal(size_t index, std::function<void()>& task);
+    void run(size_t index, const std::vector<int>& cpus);
+
+public:
+    // cpus - ядра, до яких прив'язуються потоки виконавця (порожньо - без прив'язки)
+    Executor(size_t thread_count, const std::vector<int>& cpus = {});
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Після stop() завдання виконується синхронно в потоці виклику
+    void submit(std::function<void()> task);
+    // Зупинка після виконання вже поставлених завдань
+    void stop();
+    size_t threadCount() const { return queues.size(); }
+};
+
+#endif
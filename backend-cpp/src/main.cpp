@@ -4,12 +4,37 @@
 #include "DatabaseManager.h"
 #include "config/Config.h"
 #include <iostream>
+#include <future>
 #include "TaskController.h"
+#include "UploadController.h"
+#include "TaskRetention.h"
+#include "UploadSessionSweeper.h"
+#include "similarity/SimilarityIndex.h"
+#include "executor/Executor.h"
+#include "executor/AsyncHandler.h"
+#include "executor/CpuAffinity.h"
+#include <algorithm>
+#include <thread>
+#include <csignal>
+#include <pthread.h>
+#include "tracing/TracingMiddleware.h"
+#include "recording/RecordingMiddleware.h"
+#include "middleware/AdmissionControl.h"
+#include "middleware/ReadConsistency.h"
+#include "middleware/BodyLimit.h"
 
 
 int main() {
+    // SIGINT/SIGTERM чекає main (sigwait), а не Crow: маска успадковується всіма
+    // потоками, тож блокуємо сигнали до створення будь-якого з них
+    sigset_t shutdown_signals;
+    sigemptyset(&shutdown_signals);
+    sigaddset(&shutdown_signals, SIGINT);
+    sigaddset(&shutdown_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+
     // SDK and Crow app init 
-    crow::App<crow::CORSHandler> app;
+    crow::App<crow::CORSHandler, TracingMiddleware, RecordingMiddleware, AdmissionControl, BodyLimit, ReadConsistency> app;
     Aws::SDKOptions options;
     Aws::InitAPI(options);
 
@@ -19,8 +44,10 @@ int main() {
     auto& cors = app.get_middleware<crow::CORSHandler>();
     cors.global()
         .origin("*")  // allowing all origins
-        .methods("GET"_method, "POST"_method, "PUT"_method, "DELETE"_method, "OPTIONS"_method)
-        .headers("Content-Type", "Authorization", "X-Requested-With", "Origin", "Accept");
+        .methods("GET"_method, "HEAD"_method, "POST"_method, "PUT"_method, "PATCH"_method, "DELETE"_method, "OPTIONS"_method)
+        .headers("Content-Type", "Authorization", "X-Requested-With", "Origin", "Accept", "Range", "traceparent",
+                 "Upload-Offset", "Tus-Resumable")
+        .expose("Location", "Upload-Offset", "Upload-Length", "Tus-Resumable", "traceparent");
 
 
     // database config
@@ -34,63 +61,219 @@ int main() {
     //r2_config
     R2Config r2_config;
 
-    // Database initialization
+    // X-Forwarded-For враховується лише від довірених проксі
+    configureTrustedProxies(server_config.trusted_proxies);
+
+    // admission control: ліміти на клієнта та на паралельність маршрутів
+    AdmissionConfig admission_config;
+    app.get_middleware<AdmissionControl>().configure(admission_config);
+
+    // обмеження розміру тіл і бюджет пам'яті під завантаження
+    BodyLimitConfig body_limit_config;
+    app.get_middleware<BodyLimit>().configure(body_limit_config);
+    // той самий ліміт для Crow, що буферизує тіло ще до middleware
+    app.max_payload(static_cast<uint64_t>(body_limit_config.max_body_bytes));
+
+    // tracing (вимкнене за замовчуванням)
+    TracingConfig tracing_config;
+    tracing::Tracer::instance().start(tracing_config);
+
+    // запис запитів для tools/replay (вимкнений за замовчуванням)
+    RecorderConfig recorder_config;
+    recording::Recorder::instance().start(recorder_config);
+
+    // Потоки виконавця: кожен може одночасно тримати одне з'єднання до бази
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t executor_threads = server_config.executor_threads > 0 ? server_config.executor_threads : 2 * cores;
+    if (db_config.pool_size == 0) {
+        db_config.pool_size = static_cast<int>(executor_threads);
+    }
+
+    // Database and R2 initialization, readiness checks run in parallel
     DatabaseManager db_manager(db_config);
-    if (!db_manager.connect()) {
+    R2Manager r2_manager(r2_config);
+
+    auto db_ready = std::async(std::launch::async, [&db_manager]() {
+        return db_manager.connect();
+    });
+    auto r2_ready = std::async(std::launch::async, [&r2_manager]() {
+        return r2_manager.testConnect();
+    });
+
+    bool db_ok = db_ready.get();
+    bool r2_ok = r2_ready.get();
+    if (!db_ok) {
         std::cerr << "Failed to connect to database!" << std::endl;
         return 1;
     }
-
-
-    // R2  initialization
-    R2Manager r2_manager(r2_config);
-    if(!r2_manager.testConnect()){
+    if (!r2_ok) {
         std::cerr << "Failed to connect to r2" << std::endl;
         return 1;
     }
     
+    // Перенесення старих завершених завдань в архів (окреме з'єднання)
+    RetentionConfig retention_config;
+    TaskRetention task_retention(db_config, retention_config);
+    task_retention.start();
+
+    // Індекс перцептивних хешів для пошуку схожих зображень (завантажується у фоні)
+    SimilarityConfig similarity_config;
+    SimilarityIndex similarity_index(db_config, similarity_config);
+    similarity_index.start();
+
     // Image Controller initialization
-    ImageController image_controller(db_manager, r2_manager);
+    ImageController image_controller(db_manager, r2_manager, similarity_index);
     
     // Task Controller 
     TaskController task_controller(db_manager , r2_manager);
 
+    // Upload Controller (відновлювані завантаження частинами)
+    UploadSessionConfig upload_session_config;
+    UploadController upload_controller(db_manager, r2_manager, upload_session_config);
+
+    // Скасування покинутих сесій завантаження та їх multipart завантажень у R2
+    UploadSessionSweeper upload_sweeper(db_manager, r2_manager, upload_session_config);
+    upload_sweeper.start();
+
+    // Виконавець для блокуючої роботи; створюється до прив'язки головного потоку,
+    // тож не успадковує ядра I/O потоків
+    Executor executor(executor_threads, server_config.executor_cpus);
+
     // routes
+    // Обробники з блокуючими запитами до бази та R2 виконуються у виконавці,
+    // I/O потоки Crow лише приймають запити і віддають відповіді
     CROW_ROUTE(app, "/api/images")
         .methods("POST"_method)
-        ([&image_controller](const crow::request& req) {
-            return image_controller.uploadImage(req);
+        ([&executor, &image_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&image_controller](const crow::request& req) {
+                return image_controller.uploadImage(req);
+            });
         });
     
+    CROW_ROUTE(app, "/api/images/upload-url")
+        .methods("POST"_method)
+        ([&executor, &image_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&image_controller](const crow::request& req) {
+                return image_controller.createUploadUrl(req);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/images/<int>/complete")
+        .methods("POST"_method)
+        ([&executor, &image_controller](const crow::request& req, crow::response& res, int id) {
+            runAsync(executor, req, res, [&image_controller, id](const crow::request& req) {
+                return image_controller.completeUpload(req, id);
+            });
+        });
+
     CROW_ROUTE(app, "/api/images")
         .methods("GET"_method)
-        ([&image_controller](const crow::request& req) {
-            return image_controller.getAllImages(req);
+        ([&executor, &image_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&image_controller](const crow::request& req) {
+                // ?ids=1,2,3 - пакетне отримання сторінки зображень
+                if (req.url_params.get("ids")) {
+                    return image_controller.getImagesByIds(req);
+                }
+                return image_controller.getAllImages(req);
+            });
         });
     
     CROW_ROUTE(app, "/api/images/<int>")
         .methods("GET"_method)
-        ([&image_controller](const crow::request& req, int id) {
-            return image_controller.getImageById(req, id);
+        ([&executor, &image_controller](const crow::request& req, crow::response& res, int id) {
+            runAsync(executor, req, res, [&image_controller, id](const crow::request& req) {
+                return image_controller.getImageById(req, id);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/images/<int>/content")
+        .methods("GET"_method)
+        ([&executor, &image_controller](const crow::request& req, crow::response& res, int id) {
+            runAsync(executor, req, res, [&image_controller, id](const crow::request& req) {
+                return image_controller.getImageContent(req, id);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/images/<int>/similar")
+        .methods("GET"_method)
+        ([&executor, &image_controller](const crow::request& req, crow::response& res, int id) {
+            runAsync(executor, req, res, [&image_controller, id](const crow::request& req) {
+                return image_controller.getSimilarImages(req, id);
+            });
         });
 
     CROW_ROUTE(app, "/api/images/status/<string>")
         .methods("GET"_method)
-        ([&image_controller](const crow::request& req, const std::string& status) {
-            return image_controller.getImagesByStatus(req, status);
+        ([&executor, &image_controller](const crow::request& req, crow::response& res, const std::string& status) {
+            runAsync(executor, req, res, [&image_controller, status](const crow::request& req) {
+                return image_controller.getImagesByStatus(req, status);
+            });
         });
 
     CROW_ROUTE(app, "/api/tasks/<int>")
         .methods("GET"_method)
-        ([&task_controller](const crow::request& req , int image_id) {
-            return task_controller.getTasks(req ,image_id);
+        ([&executor, &task_controller](const crow::request& req, crow::response& res, int image_id) {
+            runAsync(executor, req, res, [&task_controller, image_id](const crow::request& req) {
+                return task_controller.getTasks(req, image_id);
+            });
         });
     CROW_ROUTE(app, "/api/tasks")
+        .methods("GET"_method)
+        ([&executor, &task_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&task_controller](const crow::request& req) {
+                return task_controller.getTasksForImages(req);
+            });
+        });
+    CROW_ROUTE(app, "/api/tasks")
+        .methods("POST"_method)
+        ([&executor, &task_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&task_controller](const crow::request& req) {
+                return task_controller.createTask(req);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/uploads")
         .methods("POST"_method)
-        ([&task_controller](const crow::request& req) {
-            return task_controller.createTask(req);
+        ([&executor, &upload_controller](const crow::request& req, crow::response& res) {
+            runAsync(executor, req, res, [&upload_controller](const crow::request& req) {
+                return upload_controller.createSession(req);
+            });
         });
 
+    // HEAD обробляється Crow через GET маршрут без тіла
+    CROW_ROUTE(app, "/api/uploads/<string>")
+        .methods("GET"_method)
+        ([&executor, &upload_controller](const crow::request& req, crow::response& res, const std::string& id) {
+            runAsync(executor, req, res, [&upload_controller, id](const crow::request& req) {
+                return upload_controller.getSession(req, id);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/uploads/<string>")
+        .methods("PATCH"_method)
+        ([&executor, &upload_controller](const crow::request& req, crow::response& res, const std::string& id) {
+            runAsync(executor, req, res, [&upload_controller, id](const crow::request& req) {
+                return upload_controller.uploadChunk(req, id);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/uploads/<string>")
+        .methods("DELETE"_method)
+        ([&executor, &upload_controller](const crow::request& req, crow::response& res, const std::string& id) {
+            runAsync(executor, req, res, [&upload_controller, id](const crow::request& req) {
+                return upload_controller.abortSession(req, id);
+            });
+        });
+
+    CROW_ROUTE(app, "/api/uploads/<string>/complete")
+        .methods("POST"_method)
+        ([&executor, &upload_controller](const crow::request& req, crow::response& res, const std::string& id) {
+            runAsync(executor, req, res, [&upload_controller, id](const crow::request& req) {
+                return upload_controller.completeSession(req, id);
+            });
+        });
+
+    // Дешевий запит - відповідає прямо з I/O потоку
     CROW_ROUTE(app, "/health")
         .methods("GET"_method)
         ([]() {
@@ -103,8 +286,33 @@ int main() {
     std::cout << "C++ API Server with CORS middleware starting on http://localhost:" 
               << server_config.port << std::endl;
     
+    // I/O потоки Crow створюються в run() і успадковують прив'язку головного потоку
+    setCurrentThreadAffinity(server_config.io_cpus);
+    unsigned int io_threads = server_config.io_threads > 0 ? server_config.io_threads : cores;
+    std::cout << "I/O threads: " << io_threads << ", executor threads: " << executor.threadCount() << std::endl;
+
     // running server with multi thread
-    app.port(server_config.port).multithreaded().run();
+    app.signal_clear();
+    auto server = app.port(server_config.port).concurrency(io_threads).run_async();
+
+    int signal_number = 0;
+    sigwait(&shutdown_signals, &signal_number);
+    std::cout << "Зупинка сервера (сигнал " << signal_number << ")" << std::endl;
+
+    // Зупинка у зворотному порядку залежностей: спершу фонові сервіси (їх потоки
+    // ходять у базу і R2, а самі об'єкти лишаються доступними обробникам), далі
+    // нові запити отримують 503, виконавець дочікує поставлені завдання, поки
+    // I/O потоки Crow ще відправляють відповіді, і лише тоді зупиняється Crow
+    upload_sweeper.stop();
+    task_retention.stop();
+    similarity_index.stop();
+    app.get_middleware<AdmissionControl>().drain();
+    executor.stop();
+    app.stop();
+    server.wait();
+    // скидання залишку журналу запитів і спанів
+    recording::Recorder::instance().stop();
+    tracing::Tracer::instance().stop();
     //shutdown  AWS SDK
     Aws::ShutdownAPI(options);
     return 0;
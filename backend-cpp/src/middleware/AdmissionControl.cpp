@@ -0,0 +1,167 @@
+#include "AdmissionControl.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+AdaptiveLimiter::AdaptiveLimiter()
+    : limit(1), min_limit(1), max_limit(1), target_latency(0), in_flight(0) {
+}
+
+void AdaptiveLimiter::configure(int min_concurrency, int max_concurrency, int target_latency_ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    min_limit = std::max(1, min_concurrency);
+    max_limit = std::max(static_cast<int>(min_limit), max_concurrency);
+    // Стартуємо з максимуму, ліміт знижується лише при реальному перевантаженні
+    limit = max_limit;
+    target_latency = std::chrono::milliseconds(target_latency_ms);
+}
+
+bool AdaptiveLimiter::tryAcquire() {
+    int current = in_flight.fetch_add(1, std::memory_order_acq_rel);
+    if (current >= currentLimit()) {
+        in_flight.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    return true;
+}
+
+void AdaptiveLimiter::release(std::chrono::microseconds latency) {
+    in_flight.fetch_sub(1, std::memory_order_acq_rel);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    if (latency > target_latency) {
+        // Не більше одного зменшення за інтервал цільової затримки,
+        // щоб хвиля повільних відповідей не обвалила ліміт до мінімуму
+        if (now - last_decrease >= target_latency) {
+            limit = std::max(min_limit, limit * 0.5);
+            last_decrease = now;
+        }
+    } else {
+        limit = std::min(max_limit, limit + 1.0 / limit);
+    }
+}
+
+int AdaptiveLimiter::currentLimit() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(limit);
+}
+
+AdmissionControl::AdmissionControl() {
+    configure(config);
+}
+
+void AdmissionControl::configure(const AdmissionConfig& admission_config) {
+    config = admission_config;
+    upload_limiter.configure(config.upload_min_concurrency, config.upload_max_concurrency,
+                             config.upload_target_latency_ms);
+    read_limiter.configure(config.read_min_concurrency, config.read_max_concurrency,
+                           config.read_target_latency_ms);
+}
+
+AdmissionControl::RouteClass AdmissionControl::classify(const crow::request& req) {
+    if (req.method == crow::HTTPMethod::Options || req.url == "/health") {
+        return RouteClass::Exempt;
+    }
+    // Запити з тілом файлу - завантаження, решта - дешеві читання та метадані
+    if ((req.method == crow::HTTPMethod::Post && req.url == "/api/images") ||
+        req.method == crow::HTTPMethod::Patch || req.method == crow::HTTPMethod::Put) {
+        return RouteClass::Upload;
+    }
+    return RouteClass::Read;
+}
+
+int AdmissionControl::takeToken(const std::string& client) {
+    Shard& shard = shards[std::hash<std::string>{}(client) % SHARD_COUNT];
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Періодичне видалення неактивних клієнтів (повний bucket = нічого пам'ятати)
+    if (++shard.requests_since_cleanup >= 4096) {
+        shard.requests_since_cleanup = 0;
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            double idle = std::chrono::duration<double>(now - it->second.last_refill).count();
+            if (it->second.tokens + idle * config.client_rate >= config.client_burst) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    auto it = shard.buckets.find(client);
+    if (it == shard.buckets.end()) {
+        it = shard.buckets.emplace(client, Bucket{config.client_burst, now}).first;
+    }
+
+    Bucket& bucket = it->second;
+    double elapsed = std::chrono::duration<double>(now - bucket.last_refill).count();
+    bucket.tokens = std::min(config.client_burst, bucket.tokens + elapsed * config.client_rate);
+    bucket.last_refill = now;
+
+    if (bucket.tokens >= 1.0) {
+        bucket.tokens -= 1.0;
+        return 0;
+    }
+    return std::max(1, static_cast<int>(std::ceil((1.0 - bucket.tokens) / config.client_rate)));
+}
+
+void AdmissionControl::reject(crow::response& res, int code, int retry_after, const std::string& message) {
+    res.code = code;
+    res.set_header("Retry-After", std::to_string(retry_after));
+    res.body = message;
+    res.end();
+}
+
+void AdmissionControl::before_handle(crow::request& req, crow::response& res, context& ctx) {
+    // Під час зупинки не приймаємо нову роботу незалежно від класу маршруту
+    if (draining.load(std::memory_order_acquire) && req.method != crow::HTTPMethod::Options) {
+        res.set_header("Connection", "close");
+        reject(res, 503, 1, "Сервер зупиняється");
+        return;
+    }
+
+    ctx.route_class = config.enabled ? classify(req) : RouteClass::Exempt;
+    if (ctx.route_class == RouteClass::Exempt) {
+        return;
+    }
+
+    int retry_after = takeToken(clientAddress(req));
+    if (retry_after > 0) {
+        reject(res, 429, retry_after, "Забагато запитів");
+        return;
+    }
+
+    AdaptiveLimiter& limiter = ctx.route_class == RouteClass::Upload ? upload_limiter : read_limiter;
+    if (!limiter.tryAcquire()) {
+        reject(res, 503, 1, "Сервер перевантажений, спробуйте пізніше");
+        return;
+    }
+
+    ctx.admitted = true;
+    // BodyLimit іде далі в ланцюжку і може забрати тіло з req.body
+    ctx.body_bytes = static_cast<long long>(req.body.size());
+    ctx.start = std::chrono::steady_clock::now();
+}
+
+void AdmissionControl::after_handle(crow::request& req, crow::response& res, context& ctx) {
+    // after_handle викликається і для відхилених запитів
+    if (!ctx.admitted) {
+        return;
+    }
+    ctx.admitted = false;
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - ctx.start);
+    // Час завантаження росте з розміром тіла (копіювання, запис у R2): для великих
+    // тіл з ціллю порівнюється затримка на одиницю обсягу, інакше кілька великих
+    // файлів зменшували б ліміт без реального перевантаження
+    long long unit_bytes = static_cast<long long>(config.upload_latency_unit_kb) * 1024;
+    if (ctx.route_class == RouteClass::Upload && ctx.body_bytes > unit_bytes) {
+        latency = std::chrono::microseconds(static_cast<long long>(
+            static_cast<double>(latency.count()) * unit_bytes / ctx.body_bytes));
+    }
+    AdaptiveLimiter& limiter = ctx.route_class == RouteClass::Upload ? upload_limiter : read_limiter;
+    limiter.release(latency);
+}
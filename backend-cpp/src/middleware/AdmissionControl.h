@@ -0,0 +1,81 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include "crow.h"
+#include "../config/Config.h"
+#include "ClientAddress.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Адаптивний ліміт паралельності (AIMD): ліміт росте на 1 за "вікно" запитів
+// з нормальною затримкою і зменшується вдвічі при перевищенні цільової затримки
+class AdaptiveLimiter {
+private:
+    std::mutex mutex;
+    double limit;
+    double min_limit;
+    double max_limit;
+    std::chrono::microseconds target_latency;
+    std::chrono::steady_clock::time_point last_decrease;
+    std::atomic<int> in_flight;
+
+public:
+    AdaptiveLimiter();
+    void configure(int min_concurrency, int max_concurrency, int target_latency_ms);
+
+    bool tryAcquire();
+    void release(std::chrono::microseconds latency);
+    int currentLimit();
+};
+
+// Crow middleware для admission control: token bucket на клієнта, окремі
+// адаптивні ліміти для завантажень і читань. Надлишкові запити швидко
+// отримують 429/503 з Retry-After замість того, щоб накопичуватися
+class AdmissionControl {
+public:
+    enum class RouteClass { Exempt, Upload, Read };
+
+    struct context {
+        RouteClass route_class = RouteClass::Exempt;
+        bool admitted = false;
+        long long body_bytes = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    AdmissionControl();
+    void configure(const AdmissionConfig& admission_config);
+    // Зупинка сервера: нові запити отримують 503, поки виконавець дочікує поставлені
+    void drain() { draining.store(true, std::memory_order_release); }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+private:
+    struct Bucket {
+        double tokens;
+        std::chrono::steady_clock::time_point last_refill;
+    };
+
+    static constexpr size_t SHARD_COUNT = 16;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Bucket> buckets;
+        size_t requests_since_cleanup = 0;
+    };
+
+    AdmissionConfig config;
+    std::atomic<bool> draining{false};
+    Shard shards[SHARD_COUNT];
+    AdaptiveLimiter upload_limiter;
+    AdaptiveLimiter read_limiter;
+
+    static RouteClass classify(const crow::request& req);
+    // Повертає 0 якщо токен видано, інакше кількість секунд до появи токена
+    int takeToken(const std::string& client);
+    void reject(crow::response& res, int code, int retry_after, const std::string& message);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "BodyLimit.h"
+#include <iostream>
+#include <string>
+
+std::string BodyLimit::spool_dir;
+std::mutex BodyLimit::spooled_mutex;
+std::unordered_map<const crow::request*, std::shared_ptr<BodyLimit::HandedBody>> BodyLimit::spooled_bodies;
+
+BodyLimit::BodyLimit()
+    : in_flight_bytes(0) {
+}
+
+void BodyLimit::configure(const BodyLimitConfig& body_limit_config) {
+    config = body_limit_config;
+    spool_dir = config.spool_dir;
+}
+
+// Лише маршрути, що читають тіло через BodyLimit::body: завантаження файлу і частин
+bool BodyLimit::spoolable(const crow::request& req) {
+    return (req.method == crow::HTTPMethod::Post && req.url == "/api/images") ||
+           (req.method == crow::HTTPMethod::Patch && req.url.rfind("/api/uploads/", 0) == 0);
+}
+
+bool BodyLimit::reserve(long long bytes) {
+    long long current = in_flight_bytes.load(std::memory_order_relaxed);
+    do {
+        if (current + bytes > config.inflight_budget_bytes) {
+            return false;
+        }
+    } while (!in_flight_bytes.compare_exchange_weak(current, current + bytes, std::memory_order_acq_rel));
+    return true;
+}
+
+void BodyLimit::reject(crow::response& res, int code, const std::string& message) {
+    res.code = code;
+    if (code == 503) {
+        res.set_header("Retry-After", "1");
+    }
+    res.body = message;
+    res.end();
+}
+
+void BodyLimit::before_handle(crow::request& req, crow::response& res, context& ctx) {
+    long long size = static_cast<long long>(req.body.size());
+    if (size == 0) {
+        return;
+    }
+    if (size > config.max_body_bytes) {
+        reject(res, 413, "Тіло запиту більше за " + std::to_string(config.max_body_bytes) + " байт");
+        return;
+    }
+    if (!reserve(size)) {
+        reject(res, 503, "Забагато одночасних завантажень, спробуйте пізніше");
+        return;
+    }
+    ctx.reserved = size;
+
+    if (size <= config.spool_threshold_bytes || !spoolable(req)) {
+        return;
+    }
+    // Запис у файл блокував би потік I/O, тому тут лише передаємо буфер тіла
+    // (переміщення без копії), а пише у файл BodyLimit::body у потоці виконавця
+    auto handed = std::make_shared<HandedBody>();
+    handed->pending = std::move(req.body);
+    req.body.clear();
+    {
+        std::lock_guard<std::mutex> lock(spooled_mutex);
+        spooled_bodies[&req] = std::move(handed);
+    }
+    ctx.spooled = true;
+}
+
+void BodyLimit::after_handle(crow::request& req, crow::response& res, context& ctx) {
+    if (ctx.spooled) {
+        std::lock_guard<std::mutex> lock(spooled_mutex);
+        spooled_bodies.erase(&req);
+        ctx.spooled = false;
+    }
+    if (ctx.reserved > 0) {
+        in_flight_bytes.fetch_sub(ctx.reserved, std::memory_order_acq_rel);
+        ctx.reserved = 0;
+    }
+}
+
+std::string_view BodyLimit::body(const crow::request& req) {
+    std::shared_ptr<HandedBody> handed;
+    {
+        std::lock_guard<std::mutex> lock(spooled_mutex);
+        auto it = spooled_bodies.find(&req);
+        if (it == spooled_bodies.end()) {
+            return req.body;
+        }
+        handed = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(handed->mutex);
+    // Лише одна спроба: після невдачі хтось уже може читати pending
+    if (!handed->attempted) {
+        handed->attempted = true;
+        handed->spooled = SpooledBody::create(spool_dir, handed->pending);
+        if (handed->spooled) {
+            std::string().swap(handed->pending);
+        }
+        // Інакше диск недоступний - обробляємо з пам'яті, бюджет однаково обмежує її
+    }
+    if (handed->spooled) {
+        return handed->spooled->view();
+    }
+    return handed->pending;
+}
@@ -0,0 +1,64 @@
+#ifndef BODY_LIMIT_H
+#define BODY_LIMIT_H
+
+#include "crow.h"
+#include "../config/Config.h"
+#include "../SpooledBody.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+// Crow middleware, що обмежує утримання тіл запитів після їх читання:
+//  - тіла більші за max_body_bytes відхиляються з 413;
+//  - сума тіл запитів, що зараз в обробці (разом із чергою виконавця), не
+//    перевищує inflight_budget_bytes, інакше 503 з Retry-After;
+//  - тіла завантажень більші за spool_threshold_bytes переносяться у
+//    тимчасовий файл (SpooledBody). У before_handle (потік I/O Crow) тіло лише
+//    переміщується з req.body без копіювання; запис у файл робить перший виклик
+//    BodyLimit::body(req) у потоці виконавця, там же звільняється пам'ять тіла.
+// Crow читає тіло повністю в пам'ять до before_handle, тож ці перевірки не
+// обмежують пік читання: тіло до max_body_bytes вже буферизоване. Верхню межу
+// на рівні Crow задає app.max_payload(max_body_bytes) у main.cpp.
+// Обробники завантажень читають тіло через BodyLimit::body(req)
+class BodyLimit {
+public:
+    struct context {
+        long long reserved = 0;
+        bool spooled = false;
+    };
+
+    BodyLimit();
+    void configure(const BodyLimitConfig& body_limit_config);
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+    // Тіло запиту: відображений тимчасовий файл або req.body. Дійсне до
+    // завершення відповіді. Викликається з потоку виконавця: перший виклик
+    // для великого тіла записує його у файл
+    static std::string_view body(const crow::request& req);
+
+private:
+    // Тіло, передане з потоку I/O; pending звільняється після запису у файл
+    struct HandedBody {
+        std::mutex mutex;
+        std::string pending;
+        std::unique_ptr<SpooledBody> spooled;
+        bool attempted = false;
+    };
+
+    BodyLimitConfig config;
+    std::atomic<long long> in_flight_bytes;
+
+    static std::string spool_dir;
+    static std::mutex spooled_mutex;
+    static std::unordered_map<const crow::request*, std::shared_ptr<HandedBody>> spooled_bodies;
+
+    static bool spoolable(const crow::request& req);
+    bool reserve(long long bytes);
+    void reject(crow::response& res, int code, const std::string& message);
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "ClientAddress.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+struct Network {
+    int family;
+    unsigned char address[16];
+    int prefix;
+};
+
+// Заповнюється при старті і далі лише читається
+std::vector<Network> trusted_networks;
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(' ');
+    if (start == std::string::npos) {
+        return "";
+    }
+    return value.substr(start, value.find_last_not_of(' ') - start + 1);
+}
+
+// IPv4-mapped IPv6 (::ffff:a.b.c.d) зводиться до IPv4
+bool parseAddress(const std::string& text, int& family, unsigned char* address) {
+    if (inet_pton(AF_INET, text.c_str(), address) == 1) {
+        family = AF_INET;
+        return true;
+    }
+    if (inet_pton(AF_INET6, text.c_str(), address) == 1) {
+        static const unsigned char mapped_prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+        if (std::memcmp(address, mapped_prefix, sizeof(mapped_prefix)) == 0) {
+            std::memmove(address, address + 12, 4);
+            family = AF_INET;
+        } else {
+            family = AF_INET6;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool isTrusted(const std::string& text) {
+    if (trusted_networks.empty()) {
+        return false;
+    }
+    int family;
+    unsigned char address[16];
+    if (!parseAddress(text, family, address)) {
+        return false;
+    }
+    for (const auto& network : trusted_networks) {
+        if (network.family != family) {
+            continue;
+        }
+        int full_bytes = network.prefix / 8;
+        int rest_bits = network.prefix % 8;
+        if (std::memcmp(address, network.address, full_bytes) != 0) {
+            continue;
+        }
+        if (rest_bits > 0) {
+            unsigned char mask = static_cast<unsigned char>(0xff << (8 - rest_bits));
+            if ((address[full_bytes] & mask) != (network.address[full_bytes] & mask)) {
+                continue;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+}
+
+void configureTrustedProxies(const std::string& list) {
+    trusted_networks.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = trim(list.substr(start, end - start));
+        start = end + 1;
+        if (item.empty()) {
+            continue;
+        }
+
+        Network network{};
+        std::string address = item;
+        int prefix = -1;
+        size_t slash = item.find('/');
+        if (slash != std::string::npos) {
+            address = item.substr(0, slash);
+            try {
+                prefix = std::stoi(item.substr(slash + 1));
+            } catch (const std::exception&) {
+                prefix = -2;
+            }
+        }
+        if (!parseAddress(address, network.family, network.address)) {
+            std::cerr << "Warning: Invalid TRUSTED_PROXIES entry ignored: " << item << std::endl;
+            continue;
+        }
+        int max_prefix = network.family == AF_INET ? 32 : 128;
+        if (prefix == -1) {
+            prefix = max_prefix;
+        }
+        if (prefix < 0 || prefix > max_prefix) {
+            std::cerr << "Warning: Invalid TRUSTED_PROXIES entry ignored: " << item << std::endl;
+            continue;
+        }
+        network.prefix = prefix;
+        trusted_networks.push_back(network);
+    }
+}
+
+std::string clientAddress(const crow::request& req) {
+    if (!isTrusted(req.remote_ip_address)) {
+        return req.remote_ip_address;
+    }
+    std::string forwarded = req.get_header_value("X-Forwarded-For");
+    // Кожен проксі дописує адресу свого співрозмовника праворуч, тож ліві
+    // значення міг підставити сам клієнт. Йдемо справа до першої недовіреної адреси
+    std::string client = req.remote_ip_address;
+    size_t end = forwarded.size();
+    while (end > 0) {
+        size_t comma = forwarded.rfind(',', end - 1);
+        size_t start = comma == std::string::npos ? 0 : comma + 1;
+        std::string hop = trim(forwarded.substr(start, end - start));
+        if (!hop.empty()) {
+            if (!isTrusted(hop)) {
+                return hop;
+            }
+            client = hop;
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        end = comma;
+    }
+    return client;
+}
@@ -0,0 +1,16 @@
+#ifndef CLIENT_ADDRESS_H
+#define CLIENT_ADDRESS_H
+
+#include "crow.h"
+#include <string>
+
+// Список довірених проксі через кому: адреси або мережі CIDR, напр. "10.0.0.0/8,::1".
+// Викликається один раз при старті, до запуску сервера
+void configureTrustedProxies(const std::string& list);
+
+// Адреса клієнта запиту. X-Forwarded-For враховується лише коли з'єднання прийшло
+// від довіреного проксі: береться найправіша адреса, що не належить довіреним проксі.
+// Інакше - адреса з'єднання, бо заголовок може підставити будь-який клієнт
+std::string clientAddress(const crow::request& req);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef READ_CONSISTENCY_H
+#define READ_CONSISTENCY_H
+
+#include "crow.h"
+#include "ClientAddress.h"
+#include "../DatabaseManager.h"
+#include <memory>
+
+// Crow middleware: прив'язує запит до клієнта, щоб після власного запису
+// клієнт читав з primary (read-your-writes при читанні з реплік)
+struct ReadConsistency {
+    struct context {
+        std::unique_ptr<DatabaseManager::ClientScope> scope;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.scope = std::make_unique<DatabaseManager::ClientScope>(clientAddress(req));
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.scope.reset();
+    }
+};
+
+#endif
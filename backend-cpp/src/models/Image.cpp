@@ -1,33 +1,43 @@
 #include "Image.h"
+#include "TimeFormat.h"
 #include <sstream>
 #include <iostream>
 #include <pqxx/pqxx>
 
+namespace {
+
+std::string_view storeField(const pqxx::field& field, StringArena& arena) {
+    if (field.is_null()) {
+        return std::string_view();
+    }
+    return arena.store(field.c_str(), field.size());
+}
+
+}
+
 Image::Image() 
-    : id(-1), status("pending") {
+    : id(-1), status(ImageStatus::Pending), size_bytes(0), created_at(0), updated_at(0) {
 }
 
-Image::Image(const std::string& name, const std::string& description,
-             const std::string& filename, const std::string& url ,const std::string& processed_path  ,const std::string& status )
-    : id(-1), name(name), description(description), filename(filename),
-      original_path(url), processed_path(url) , status(status) {}
+Image::Image(std::string_view name, std::string_view description,
+             std::string_view filename, std::string_view url, std::string_view processed_path, ImageStatus status)
+    : id(-1), status(status), size_bytes(0), created_at(0), updated_at(0),
+      name(name), description(description), filename(filename),
+      original_path(url), processed_path(processed_path) {}
 
-void Image::fromPgResult(const pqxx::row& row) {
-    id = row["id"].as<int>();
-    name = row["name"].as<std::string>();
-    filename = row["filename"].as<std::string>();
-    original_path = row["original_path"].as<std::string>();
-    processed_path = row["processed_path"].as<std::string>();
-    status = row["status"].as<std::string>();
-    
-    if (!row["error_message"].is_null()) {
-        error_message = row["error_message"].as<std::string>();
-    }
-    
-    description  = row["description"].as<std::string>();
-    
-    created_at = row["created_at"].as<std::string>();
-    updated_at = row["updated_at"].as<std::string>();
+void Image::fromPgResult(const pqxx::row& row, StringArena& arena) {
+    id = row[0].as<int>();
+    name = storeField(row[1], arena);
+    description = storeField(row[2], arena);
+    filename = storeField(row[3], arena);
+    original_path = storeField(row[4], arena);
+    processed_path = storeField(row[5], arena);
+    status = imageStatusFromString(std::string_view(row[6].c_str(), row[6].size()));
+    error_message = storeField(row[7], arena);
+    size_bytes = row[8].is_null() ? 0 : row[8].as<long long>();
+    checksum = storeField(row[9], arena);
+    created_at = row[10].is_null() ? 0 : row[10].as<int64_t>();
+    updated_at = row[11].is_null() ? 0 : row[11].as<int64_t>();
 }
 
 std::string Image::toJson() const {
@@ -39,10 +49,12 @@ std::string Image::toJson() const {
          << "\"filename\":\"" << filename << "\","
          << "\"original_path\":\"" << original_path << "\","
          << "\"processed_path\":\"" << processed_path << "\","
-         << "\"status\":\"" << status << "\","
+         << "\"status\":\"" << toString(status) << "\","
          << "\"error_message\":\"" << error_message << "\","
-         << "\"created_at\":\"" << created_at << "\","
-         << "\"updated_at\":\"" << updated_at << "\""
+         << "\"size_bytes\":" << size_bytes << ","
+         << "\"checksum\":\"" << checksum << "\","
+         << "\"created_at\":\"" << formatTimestamp(created_at) << "\","
+         << "\"updated_at\":\"" << formatTimestamp(updated_at) << "\""
          << "}";
     return json.str();
-}
\ No newline at end of file
+}
@@ -2,29 +2,77 @@
 #define IMAGE_H
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 #include <pqxx/pqxx> 
+#include "StringArena.h"
 
+enum class ImageStatus : uint8_t {
+    Pending,
+    AwaitingUpload,
+    Uploaded,
+    Processing,
+    Completed,
+    Error,
+    Unknown
+};
+
+constexpr std::string_view IMAGE_STATUS_NAMES[] = {
+    "pending", "awaiting_upload", "uploaded", "processing", "completed", "error", "unknown"
+};
+
+constexpr std::string_view toString(ImageStatus status) {
+    return IMAGE_STATUS_NAMES[static_cast<size_t>(status)];
+}
+
+constexpr ImageStatus imageStatusFromString(std::string_view value) {
+    for (size_t i = 0; i < static_cast<size_t>(ImageStatus::Unknown); ++i) {
+        if (IMAGE_STATUS_NAMES[i] == value) {
+            return static_cast<ImageStatus>(i);
+        }
+    }
+    return ImageStatus::Unknown;
+}
+
+// Рядкові поля - string_view на арену результату запиту (або на рядки
+// викликаючого коду для нових зображень), тому Image не володіє даними
 class Image {
 public:
+    // Список колонок у порядку, який очікує fromPgResult
+    static constexpr const char* SELECT_COLUMNS =
+        "id, name, description, filename, original_path, processed_path, status, error_message, "
+        "size_bytes, checksum, "
+        "(EXTRACT(EPOCH FROM created_at) * 1000000)::BIGINT AS created_at, "
+        "(EXTRACT(EPOCH FROM updated_at) * 1000000)::BIGINT AS updated_at";
+
     int id;
-    std::string name;
-    std::string description;
-    std::string filename;
-    std::string original_path;
-    std::string processed_path;
-    std::string status;  // "pending", "processing", "completed", "error"
-    std::string error_message;
-    std::string created_at;
-    std::string updated_at;
+    ImageStatus status;
+    long long size_bytes;      // розмір оригіналу в байтах (0 якщо невідомий)
+    int64_t created_at;        // мікросекунди від epoch
+    int64_t updated_at;
+    std::string_view name;
+    std::string_view description;
+    std::string_view filename;
+    std::string_view original_path;
+    std::string_view processed_path;
+    std::string_view error_message;
+    std::string_view checksum; // MD5 оригіналу (hex), може бути порожнім
     Image();
     
     // Конструктор для нових зображень
-    Image(const std::string& name, const std::string& description,
-             const std::string& filename, const std::string& url , const std::string& processed_path  ,const std::string& status );
+    Image(std::string_view name, std::string_view description,
+          std::string_view filename, std::string_view url, std::string_view processed_path, ImageStatus status);
     std::string toJson() const;
     
-    // Заповнення з результату запиту
-    void fromPgResult(const pqxx::row& row);
+    // Заповнення з результату запиту (колонки SELECT_COLUMNS), рядки копіюються в арену
+    void fromPgResult(const pqxx::row& row, StringArena& arena);
+};
+
+// Результат спискового запиту: зображення разом з ареною їхніх рядків
+struct ImageList {
+    StringArena arena;
+    std::vector<Image> items;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,88 @@
+#include "OutputOptions.h"
+#include <sstream>
+#include <iomanip>
+
+OutputOptions::OutputOptions()
+    : quality(0), progressive(false), min_psnr(0) {
+}
+
+bool OutputOptions::set(const std::string& key, const std::string& value, std::string& error) {
+    if (value.empty()) {
+        return true;
+    }
+
+    if (key == "output_format") {
+        if (value == "jpg") {
+            format = "jpeg";
+        } else if (value == "jpeg" || value == "png" || value == "webp") {
+            format = value;
+        } else if (value != "original") {
+            error = "Непідтримуваний формат: " + value;
+            return false;
+        }
+    } else if (key == "quality") {
+        try {
+            quality = std::stoi(value);
+        } catch (const std::exception&) {
+            quality = -1;
+        }
+        if (quality < 1 || quality > 100) {
+            error = "Якість має бути в межах від 1 до 100";
+            return false;
+        }
+    } else if (key == "progressive") {
+        progressive = value == "1" || value == "true";
+    } else if (key == "chroma_subsampling") {
+        if (value != "444" && value != "422" && value != "420") {
+            error = "Субдискретизація має бути 444, 422 або 420";
+            return false;
+        }
+        subsampling = value;
+    } else if (key == "strip_metadata") {
+        // Кодеки OpenCV ніколи не переносять EXIF/ICC, тож метадані завжди видаляються
+        if (value == "0" || value == "false") {
+            error = "Збереження метаданих не підтримується";
+            return false;
+        }
+    } else if (key == "mode") {
+        if (value != "smallest" && value != "default") {
+            error = "Невідомий режим кодування: " + value;
+            return false;
+        }
+        mode = value == "smallest" ? value : "";
+    } else if (key == "min_psnr") {
+        try {
+            min_psnr = std::stod(value);
+        } catch (const std::exception&) {
+            min_psnr = -1;
+        }
+        if (min_psnr < 20 || min_psnr > 60) {
+            error = "min_psnr має бути в межах від 20 до 60";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string OutputOptions::canonical() const {
+    // Фіксований порядок ключів, щоб однакові параметри давали однаковий ключ кешу
+    std::ostringstream out;
+    auto append = [&out](const std::string& key, const std::string& value) {
+        if (out.tellp() > 0) {
+            out << '&';
+        }
+        out << key << '=' << value;
+    };
+
+    if (!format.empty()) append("format", format);
+    if (quality > 0) append("quality", std::to_string(quality));
+    if (progressive) append("progressive", "1");
+    if (!subsampling.empty()) append("subsampling", subsampling);
+    if (!mode.empty()) {
+        append("mode", mode);
+        std::ostringstream psnr;
+        psnr << std::fixed << std::setprecision(1) << (min_psnr > 0 ? min_psnr : 40.0);
+        append("min_psnr", psnr.str());
+    }
+    return out.str();
+}
@@ -0,0 +1,25 @@
+#ifndef OUTPUT_OPTIONS_H
+#define OUTPUT_OPTIONS_H
+
+#include <string>
+
+// Параметри кодування результату обробки. Канонічний рядок зберігається в
+// tasks.output_options, розбирається Python обробником і є частиною ключа
+// кешу результатів (порожній рядок - кодування за замовчуванням)
+class OutputOptions {
+public:
+    std::string format;       // "", "jpeg", "png", "webp" ("" - як у оригіналу)
+    int quality;              // 1..100, 0 - за замовчуванням кодека
+    bool progressive;         // прогресивний JPEG
+    std::string subsampling;  // "", "444", "422", "420" (JPEG)
+    std::string mode;         // "", "smallest" - найменший розмір у межах min_psnr
+    double min_psnr;          // поріг якості для режиму smallest (дБ)
+
+    OutputOptions();
+
+    // Встановлення одного поля з форми запиту; false і опис помилки якщо значення невірне
+    bool set(const std::string& key, const std::string& value, std::string& error);
+    std::string canonical() const;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "StringArena.h"
+#include <cstring>
+
+StringArena::StringArena()
+    : cursor(nullptr), remaining(0) {
+}
+
+StringArena::StringArena(StringArena&& other) noexcept
+    : blocks(std::move(other.blocks)), cursor(other.cursor), remaining(other.remaining) {
+    other.blocks.clear();
+    other.cursor = nullptr;
+    other.remaining = 0;
+}
+
+StringArena& StringArena::operator=(StringArena&& other) noexcept {
+    if (this != &other) {
+        blocks = std::move(other.blocks);
+        cursor = other.cursor;
+        remaining = other.remaining;
+        other.blocks.clear();
+        other.cursor = nullptr;
+        other.remaining = 0;
+    }
+    return *this;
+}
+
+std::string_view StringArena::store(const char* data, size_t size) {
+    if (size == 0) {
+        return std::string_view();
+    }
+
+    if (size > remaining) {
+        // Великі рядки отримують окремий блок, щоб не марнувати залишок поточного
+        if (size > BLOCK_SIZE / 4) {
+            blocks.push_back(std::make_unique<char[]>(size));
+            std::memcpy(blocks.back().get(), data, size);
+            return std::string_view(blocks.back().get(), size);
+        }
+        blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        cursor = blocks.back().get();
+        remaining = BLOCK_SIZE;
+    }
+
+    std::memcpy(cursor, data, size);
+    std::string_view result(cursor, size);
+    cursor += size;
+    remaining -= size;
+    return result;
+}
@@ -0,0 +1,33 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Арена рядків для результатів запитів: рядки копіюються у великі блоки,
+// а моделі зберігають лише std::string_view на них.
+// Переміщення арени не інвалідує видані string_view.
+class StringArena {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor;
+    size_t remaining;
+
+public:
+    StringArena();
+    // Блоки переходять до нової арени; джерело лишається порожнім і придатним
+    // до повторного використання (без курсора в чужий блок)
+    StringArena(StringArena&& other) noexcept;
+    StringArena& operator=(StringArena&& other) noexcept;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    std::string_view store(const char* data, size_t size);
+    std::string_view store(std::string_view value) { return store(value.data(), value.size()); }
+};
+
+#endif
@@ -1,45 +1,46 @@
 #include "Task.h"
+#include "TimeFormat.h"
 #include <sstream>
 #include <iostream>
 #include <pqxx/pqxx>
 
 Task::Task() 
-    : id(-1), status("pending") {
+    : id(-1), image_id(-1), processing_type(ProcessingType::Unknown), status(TaskStatus::Pending),
+      priority(0), created_at(0), completed_at(-1), duration(-1), attempts(0) {
 }
 
-Task::Task(int image_id, const std::string& processing_type, const std::string& status)
-    : id(-1), image_id(image_id), processing_type(processing_type), status(status) {}
+Task::Task(int image_id, ProcessingType processing_type, TaskStatus status)
+    : id(-1), image_id(image_id), processing_type(processing_type), status(status),
+      priority(0), created_at(0), completed_at(-1), duration(-1), attempts(0) {}
 
     
-void Task::fromPgResult(const pqxx::row& row) {
-    id = row["id"].as<int>();
-    image_id = row["image_id"].as<int>();
-    processing_type = row["processing_type"].as<std::string>();
-    status = row["status"].as<std::string>();
-    
-    
-    if (!row["duration"].is_null()) {
-    duration = row["duration"].as<std::string>();
-    } else {
-        duration = "";
-    }
-    created_at = row["created_at"].as<std::string>();
-    if (!row["completed_at"].is_null()) {
-        completed_at = row["completed_at"].as<std::string>();
-    } else {
-        completed_at = "";
-    }
+void Task::fromPgResult(const pqxx::row& row, StringArena& arena) {
+    id = row[0].as<int>();
+    image_id = row[1].as<int>();
+    processing_type = processingTypeFromString(std::string_view(row[2].c_str(), row[2].size()));
+    status = taskStatusFromString(std::string_view(row[3].c_str(), row[3].size()));
+    priority = row[4].as<int>();
+    created_at = row[5].is_null() ? 0 : row[5].as<int64_t>();
+    completed_at = row[6].is_null() ? -1 : row[6].as<int64_t>();
+    duration = row[7].is_null() ? -1 : row[7].as<int64_t>();
+    processed_path = row[8].is_null() ? std::string_view() : arena.store(row[8].c_str(), row[8].size());
+    output_options = arena.store(row[9].c_str(), row[9].size());
+    attempts = row[10].as<int>();
 }
 
 std::string Task::toJson() const {
     std::stringstream json;
     json << "{"
          << "\"id\":" << id << ","
-         << "\"processing_type\":\"" << processing_type << "\","
+         << "\"processing_type\":\"" << toString(processing_type) << "\","
          << "\"image_id\":" << image_id << "," 
-         << "\"created_at\":\"" << created_at << "\","
-         << "\"completed_at\":\"" << completed_at << "\","
-         << "\"duration\":\"" << duration << "\""
+         << "\"priority\":" << priority << ","
+         << "\"created_at\":\"" << formatTimestamp(created_at) << "\","
+         << "\"completed_at\":\"" << (completed_at < 0 ? "" : formatTimestamp(completed_at)) << "\","
+         << "\"duration\":\"" << (duration < 0 ? "" : formatDuration(duration)) << "\","
+         << "\"processed_path\":\"" << processed_path << "\","
+         << "\"output_options\":\"" << output_options << "\","
+         << "\"attempts\":" << attempts
          << "}";
     return json.str();
-}
\ No newline at end of file
+}
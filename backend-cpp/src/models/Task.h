@@ -2,24 +2,106 @@
 #define Task_H
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 #include <pqxx/pqxx> 
+#include "StringArena.h"
+
+enum class TaskStatus : uint8_t {
+    Pending,
+    Processing,
+    Completed,
+    Failed,
+    Dead,       // вичерпано спроби обробки (dead-letter)
+    Unknown
+};
+
+constexpr std::string_view TASK_STATUS_NAMES[] = {
+    "pending", "processing", "completed", "failed", "dead", "unknown"
+};
+
+// Типи обробки, які підтримує Python обробник (image_processor.ProcessingType)
+enum class ProcessingType : uint8_t {
+    WhiteBlue,
+    Grayscale,
+    Blur,
+    Sharpen,
+    EdgeDetection,
+    Sepia,
+    Invert,
+    Brightness,
+    Contrast,
+    Unknown
+};
+
+constexpr std::string_view PROCESSING_TYPE_NAMES[] = {
+    "white-blue", "grayscale", "blur", "sharpen", "edge-detection",
+    "sepia", "invert", "brightness", "contrast", "unknown"
+};
+
+constexpr std::string_view toString(TaskStatus status) {
+    return TASK_STATUS_NAMES[static_cast<size_t>(status)];
+}
+
+constexpr std::string_view toString(ProcessingType type) {
+    return PROCESSING_TYPE_NAMES[static_cast<size_t>(type)];
+}
+
+constexpr TaskStatus taskStatusFromString(std::string_view value) {
+    for (size_t i = 0; i < static_cast<size_t>(TaskStatus::Unknown); ++i) {
+        if (TASK_STATUS_NAMES[i] == value) {
+            return static_cast<TaskStatus>(i);
+        }
+    }
+    return TaskStatus::Unknown;
+}
+
+constexpr ProcessingType processingTypeFromString(std::string_view value) {
+    for (size_t i = 0; i < static_cast<size_t>(ProcessingType::Unknown); ++i) {
+        if (PROCESSING_TYPE_NAMES[i] == value) {
+            return static_cast<ProcessingType>(i);
+        }
+    }
+    return ProcessingType::Unknown;
+}
 
 class Task {
 public:
+    // Список колонок у порядку, який очікує fromPgResult
+    static constexpr const char* SELECT_COLUMNS =
+        "id, image_id, processing_type, status, priority, "
+        "(EXTRACT(EPOCH FROM created_at) * 1000000)::BIGINT AS created_at, "
+        "(EXTRACT(EPOCH FROM completed_at) * 1000000)::BIGINT AS completed_at, "
+        "(EXTRACT(EPOCH FROM duration) * 1000000)::BIGINT AS duration, "
+        "processed_path, output_options, attempts";
+
     int id;
     int image_id ;
-    std::string processing_type;
-    std::string status;  // "pending", "processing", "completed", "error"
-    std::string created_at;
-    std::string completed_at;
-    std::string duration;
+    ProcessingType processing_type;
+    TaskStatus status;
+    int priority;           // більше значення - раніше обробляється
+    int64_t created_at;     // мікросекунди від epoch
+    int64_t completed_at;   // -1 якщо завдання не завершене
+    int64_t duration;       // мікросекунди, -1 якщо невідома
+    std::string trace_id;   // trace id запиту, що створив завдання (лише для запису)
+    std::string_view processed_path; // ключ результату в R2, порожній поки завдання не завершене
+    std::string_view output_options; // канонічні параметри кодування (OutputOptions::canonical)
+    int attempts;           // скільки разів обробник брав завдання
     Task();
     
-    Task(int image_id, const std::string& processing_type, const std::string& status);
+    Task(int image_id, ProcessingType processing_type, TaskStatus status);
     
     std::string toJson() const;
     
-    void fromPgResult(const pqxx::row& row);
+    // Заповнення з результату запиту (колонки SELECT_COLUMNS), рядки копіюються в арену
+    void fromPgResult(const pqxx::row& row, StringArena& arena);
+};
+
+// Результат спискового запиту: завдання разом з ареною їхніх рядків
+struct TaskList {
+    StringArena arena;
+    std::vector<Task> items;
 };
 
-#endif
\ No newline at end of file
+#endif
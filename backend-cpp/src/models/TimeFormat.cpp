@@ -0,0 +1,58 @@
+#include "TimeFormat.h"
+#include <ctime>
+#include <cstdio>
+
+namespace {
+
+// Дробова частина секунд без кінцевих нулів, як її друкує PostgreSQL
+void appendFraction(std::string& out, int64_t micros) {
+    if (micros == 0) {
+        return;
+    }
+    char buf[8];
+    std::snprintf(buf, sizeof(buf), ".%06lld", static_cast<long long>(micros));
+    std::string fraction(buf);
+    while (fraction.back() == '0') {
+        fraction.pop_back();
+    }
+    out += fraction;
+}
+
+}
+
+std::string formatTimestamp(int64_t epoch_us) {
+    int64_t seconds = epoch_us / 1000000;
+    int64_t micros = epoch_us % 1000000;
+    if (micros < 0) {
+        micros += 1000000;
+        seconds -= 1;
+    }
+
+    std::time_t t = static_cast<std::time_t>(seconds);
+    std::tm tm_utc;
+    gmtime_r(&t, &tm_utc);
+
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm_utc);
+    std::string result(buf);
+    appendFraction(result, micros);
+    return result;
+}
+
+std::string formatDuration(int64_t duration_us) {
+    std::string result;
+    if (duration_us < 0) {
+        result += "-";
+        duration_us = -duration_us;
+    }
+
+    int64_t total_seconds = duration_us / 1000000;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld",
+                  static_cast<long long>(total_seconds / 3600),
+                  static_cast<long long>((total_seconds / 60) % 60),
+                  static_cast<long long>(total_seconds % 60));
+    result += buf;
+    appendFraction(result, duration_us % 1000000);
+    return result;
+}
@@ -0,0 +1,15 @@
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+#include <string>
+#include <cstdint>
+
+// Моделі зберігають час як мікросекунди від epoch, а рядок формується
+// лише під час серіалізації - у тому ж вигляді, що й у PostgreSQL
+
+// "2024-05-01 12:34:56.123456" (дробова частина без кінцевих нулів)
+std::string formatTimestamp(int64_t epoch_us);
+// "HH:MM:SS.ffffff" для INTERVAL
+std::string formatDuration(int64_t duration_us);
+
+#endif
@@ -0,0 +1,16 @@
+#include "UploadSession.h"
+
+UploadSession::UploadSession()
+    : image_id(-1), total_size(0), part_size(0), upload_offset(0), status("active") {
+}
+
+void UploadSession::fromPgResult(const pqxx::row& row) {
+    id = row[0].as<std::string>();
+    image_id = row[1].as<int>();
+    object_key = row[2].as<std::string>();
+    r2_upload_id = row[3].as<std::string>();
+    total_size = row[4].as<long long>();
+    part_size = row[5].as<long long>();
+    upload_offset = row[6].as<long long>();
+    status = row[7].as<std::string>();
+}
@@ -0,0 +1,28 @@
+#ifndef UPLOAD_SESSION_H
+#define UPLOAD_SESSION_H
+
+#include <string>
+#include <pqxx/pqxx>
+
+// Сесія відновлюваного завантаження: файл надсилається частинами фіксованого
+// розміру, кожна частина одразу стає частиною multipart завантаження в R2
+class UploadSession {
+public:
+    static constexpr const char* SELECT_COLUMNS =
+        "id, image_id, object_key, r2_upload_id, total_size, part_size, upload_offset, status";
+
+    std::string id;         // випадковий hex токен, порожній якщо сесію не знайдено
+    int image_id;
+    std::string object_key;
+    std::string r2_upload_id;
+    long long total_size;
+    long long part_size;
+    long long upload_offset; // кількість підтверджених байтів
+    std::string status;      // "active", "completing", "completed", "aborted"
+
+    UploadSession();
+
+    void fromPgResult(const pqxx::row& row);
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Бінарний формат журналу запитів. Спільний для RequestRecorder (сервер)
+// і tools/replay, тому без залежностей від Crow.
+//
+// Файл: FileHeader, далі записи один за одним:
+//   RecordHeader | url (url_len) | заголовки (headers_len) | тіло (body_size, лише для Sampled)
+// Заголовки - рядки "Name: value\n". Числа у порядку байтів хоста (x86/arm - little-endian).
+// Записи додаються по завершенню запиту, тож не впорядковані за offset_us.
+// Обрізаний останній запис (сервер зупинено під час запису) ігнорується.
+namespace recording {
+
+constexpr char MAGIC[8] = {'I', 'M', 'G', 'R', 'E', 'C', '0', '1'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t start_unix_us;     // час початку запису
+};
+static_assert(sizeof(FileHeader) == 24, "FileHeader layout");
+
+enum class BodyKind : uint8_t {
+    None = 0,
+    Sampled = 1,     // тіло збережене як є
+    Synthetic = 2,   // збережено лише розмір
+};
+
+enum class Method : uint8_t { Get = 0, Post, Put, Patch, Delete, Head, Options, Other };
+
+struct RecordHeader {
+    uint64_t offset_us;         // прихід запиту від початку запису
+    uint32_t latency_us;        // час обробки на сервері під час запису
+    uint32_t body_size;         // початковий розмір тіла (і для Synthetic)
+    uint16_t status;
+    uint16_t url_len;
+    uint16_t headers_len;
+    uint8_t method;
+    uint8_t body_kind;
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader layout");
+
+inline Method methodFromName(const std::string& name) {
+    if (name == "GET") return Method::Get;
+    if (name == "POST") return Method::Post;
+    if (name == "PUT") return Method::Put;
+    if (name == "PATCH") return Method::Patch;
+    if (name == "DELETE") return Method::Delete;
+    if (name == "HEAD") return Method::Head;
+    if (name == "OPTIONS") return Method::Options;
+    return Method::Other;
+}
+
+inline const char* methodName(uint8_t method) {
+    static const char* const names[] = {"GET", "POST", "PUT", "PATCH", "DELETE", "HEAD", "OPTIONS"};
+    return method < sizeof(names) / sizeof(names[0]) ? names[method] : "GET";
+}
+
+inline void appendFileHeader(std::string& out, uint64_t start_unix_us) {
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.start_unix_us = start_unix_us;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// URL і заголовки довші за 64 КБ обрізаються
+inline void appendRecord(std::string& out, RecordHeader header, const std::string& url,
+                         const std::string& headers, const std::string* body) {
+    header.url_len = static_cast<uint16_t>(std::min<size_t>(url.size(), UINT16_MAX));
+    header.headers_len = static_cast<uint16_t>(std::min<size_t>(headers.size(), UINT16_MAX));
+    header.body_kind = static_cast<uint8_t>(body ? BodyKind::Sampled :
+                                            header.body_size > 0 ? BodyKind::Synthetic : BodyKind::None);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(url, 0, header.url_len);
+    out.append(headers, 0, header.headers_len);
+    if (body) {
+        out.append(*body, 0, header.body_size);
+    }
+}
+
+// Розібраний запис; url/headers/body вказують у буфер файлу
+struct RecordView {
+    RecordHeader header;
+    const char* url;
+    const char* headers;
+    const char* body;       // nullptr, якщо тіло не збережене
+};
+
+inline bool readFileHeader(const char*& p, const char* end, FileHeader& header) {
+    if (static_cast<size_t>(end - p) < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, p, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION) {
+        return false;
+    }
+    p += sizeof(header);
+    return true;
+}
+
+// false - кінець файлу або обрізаний запис
+inline bool readRecord(const char*& p, const char* end, RecordView& record) {
+    if (static_cast<size_t>(end - p) < sizeof(RecordHeader)) {
+        return false;
+    }
+    std::memcpy(&record.header, p, sizeof(RecordHeader));
+    size_t body_len = record.header.body_kind == static_cast<uint8_t>(BodyKind::Sampled) ? record.header.body_size : 0;
+    size_t total = sizeof(RecordHeader) + record.header.url_len + record.header.headers_len + body_len;
+    if (static_cast<size_t>(end - p) < total) {
+        return false;
+    }
+    record.url = p + sizeof(RecordHeader);
+    record.headers = record.url + record.header.url_len;
+    record.body = body_len > 0 ? record.headers + record.header.headers_len : nullptr;
+    p += total;
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "Recorder.h"
+#include "RecordFormat.h"
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace recording {
+
+namespace {
+
+// Заголовки, потрібні для відтворення (boundary multipart, зсув завантаження частинами)
+const char* const RECORDED_HEADERS[] = {"Content-Type", "Upload-Offset", "Tus-Resumable"};
+
+// ID сесії завантаження - єдиний ключ доступу до неї, тож у журнал не потрапляє
+const std::string UPLOADS_PREFIX = "/api/uploads/";
+
+uint64_t micros(std::chrono::steady_clock::duration duration) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+std::string redactUrl(const std::string& raw_url) {
+    if (raw_url.compare(0, UPLOADS_PREFIX.size(), UPLOADS_PREFIX) != 0) {
+        return raw_url;
+    }
+    size_t end = raw_url.find_first_of("/?", UPLOADS_PREFIX.size());
+    if (end == std::string::npos) {
+        end = raw_url.size();
+    }
+    return UPLOADS_PREFIX + ":id" + raw_url.substr(end);
+}
+
+// Форми створення завдань і сесій завантаження - без вмісту файлів
+bool isFormRoute(const crow::request& req) {
+    return req.method == crow::HTTPMethod::Post && (req.url == "/api/tasks" || req.url == "/api/uploads");
+}
+
+}
+
+Recorder::Recorder()
+    : enabled_flag(false), dropped(0), stopping(false) {
+}
+
+Recorder& Recorder::instance() {
+    static Recorder recorder;
+    return recorder;
+}
+
+void Recorder::start(const RecorderConfig& recorder_config) {
+    if (!recorder_config.enabled) {
+        return;
+    }
+    config = recorder_config;
+    started = std::chrono::steady_clock::now();
+
+    // Новий файл на кожен запуск: зсуви записів відраховуються від цього моменту
+    std::string header;
+    uint64_t start_unix_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    appendFileHeader(header, start_unix_us);
+    std::ofstream out(config.output_path, std::ios::binary | std::ios::trunc);
+    if (!out || !out.write(header.data(), header.size())) {
+        std::cerr << "Не вдалося створити журнал запитів " << config.output_path << std::endl;
+        return;
+    }
+
+    stopping = false;
+    writer = std::thread(&Recorder::writeLoop, this);
+    enabled_flag.store(true, std::memory_order_release);
+    std::cout << "Запис запитів увімкнений, журнал у " << config.output_path << std::endl;
+}
+
+void Recorder::stop() {
+    if (!enabled()) {
+        return;
+    }
+    enabled_flag.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+// Малі тіла форм (завдань, сесій) зберігаються завжди, інші - з імовірністю body_sample_rate
+bool Recorder::keepBody(size_t size, bool form) {
+    if (form && size <= static_cast<size_t>(config.small_body_bytes)) {
+        return true;
+    }
+    if (size > static_cast<size_t>(config.max_body_bytes) || config.body_sample_rate <= 0.0) {
+        return false;
+    }
+    thread_local std::mt19937 generator(std::random_device{}());
+    return std::uniform_real_distribution<double>(0.0, 1.0)(generator) < config.body_sample_rate;
+}
+
+void Recorder::record(const crow::request& req, int status, std::chrono::steady_clock::time_point start,
+                      size_t body_size) {
+    if (!enabled()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+
+    RecordHeader header{};
+    header.offset_us = start > started ? micros(start - started) : 0;
+    header.latency_us = static_cast<uint32_t>(std::min<uint64_t>(micros(now - start), UINT32_MAX));
+    header.body_size = static_cast<uint32_t>(std::min<size_t>(body_size, UINT32_MAX));
+    header.status = static_cast<uint16_t>(status);
+    header.method = static_cast<uint8_t>(methodFromName(crow::method_name(req.method)));
+
+    std::string headers;
+    for (const char* name : RECORDED_HEADERS) {
+        std::string value = req.get_header_value(name);
+        if (!value.empty()) {
+            headers += name;
+            headers += ": ";
+            headers += value;
+            headers += '\n';
+        }
+    }
+
+    std::string encoded;
+    bool keep = !req.body.empty() && req.body.size() == body_size && keepBody(body_size, isFormRoute(req));
+    appendRecord(encoded, header, redactUrl(req.raw_url), headers, keep ? &req.body : nullptr);
+
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    if (buffer.size() + encoded.size() > static_cast<size_t>(config.buffer_bytes)) {
+        ++dropped;
+        return;
+    }
+    buffer += encoded;
+}
+
+void Recorder::writeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(config.flush_interval_ms));
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+    lock.unlock();
+    flush();
+}
+
+void Recorder::flush() {
+    std::string batch;
+    uint64_t dropped_now;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        batch.swap(buffer);
+        dropped_now = dropped;
+        dropped = 0;
+    }
+    if (dropped_now > 0) {
+        std::cerr << "Запис запитів: відкинуто записів через переповнення буфера: " << dropped_now << std::endl;
+    }
+    if (batch.empty()) {
+        return;
+    }
+
+    std::ofstream out(config.output_path, std::ios::binary | std::ios::app);
+    if (!out || !out.write(batch.data(), batch.size())) {
+        std::cerr << "Не вдалося записати журнал запитів у " << config.output_path << std::endl;
+    }
+}
+
+}
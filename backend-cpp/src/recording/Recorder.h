@@ -0,0 +1,53 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "crow.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../config/Config.h"
+
+namespace recording {
+
+// Журнал вхідних запитів для відтворення навантаження (tools/replay).
+// Запис кодується у потоці запиту в буфер, фоновий потік дописує буфер у файл.
+// Якщо буфер переповнений, запис відкидається - запит ніколи не блокується на диску
+class Recorder {
+private:
+    std::atomic<bool> enabled_flag;
+    RecorderConfig config;
+    std::chrono::steady_clock::time_point started;
+
+    std::mutex buffer_mutex;
+    std::string buffer;
+    uint64_t dropped;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    Recorder();
+    void writeLoop();
+    void flush();
+    bool keepBody(size_t size, bool form);
+
+public:
+    static Recorder& instance();
+
+    bool enabled() const { return enabled_flag.load(std::memory_order_relaxed); }
+    void start(const RecorderConfig& recorder_config);
+    void stop();
+    // body_size - розмір тіла на момент приходу запиту; якщо req.body вже
+    // звільнене, зберігається лише розмір
+    void record(const crow::request& req, int status, std::chrono::steady_clock::time_point start,
+                size_t body_size);
+};
+
+}
+
+#endif
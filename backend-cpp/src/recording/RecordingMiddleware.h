@@ -0,0 +1,34 @@
+#ifndef RECORDING_MIDDLEWARE_H
+#define RECORDING_MIDDLEWARE_H
+
+#include "crow.h"
+#include "Recorder.h"
+#include <chrono>
+
+// Crow middleware: записує кожен запит (разом з відхиленими admission control)
+// у журнал для tools/replay. Вимкнене - лише перевірка прапорця
+struct RecordingMiddleware {
+    struct context {
+        bool recording = false;
+        std::chrono::steady_clock::time_point start;
+        // BodyLimit може перенести тіло у файл і звільнити req.body до after_handle
+        size_t body_size = 0;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!recording::Recorder::instance().enabled()) {
+            return;
+        }
+        ctx.recording = true;
+        ctx.start = std::chrono::steady_clock::now();
+        ctx.body_size = req.body.size();
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (ctx.recording) {
+            recording::Recorder::instance().record(req, res.code, ctx.start, ctx.body_size);
+        }
+    }
+};
+
+#endif
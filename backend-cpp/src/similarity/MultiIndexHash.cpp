@@ -0,0 +1,116 @@
+#include "MultiIndexHash.h"
+#include <algorithm>
+#include <mutex>
+
+MultiIndexHash::MultiIndexHash() {
+    for (auto& table : tables) {
+        table.resize(1u << CHUNK_BITS);
+    }
+}
+
+void MultiIndexHash::insert(int id, uint64_t hash) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    auto it = positions.find(id);
+    if (it != positions.end()) {
+        Entry& entry = entries[it->second];
+        if (entry.hash == hash) {
+            return;
+        }
+        // Хеш змінився - прибираємо запис зі старих кошиків
+        for (int k = 0; k < CHUNKS; ++k) {
+            auto& bucket = tables[k][chunk(entry.hash, k)];
+            auto pos = std::find(bucket.begin(), bucket.end(), it->second);
+            if (pos != bucket.end()) {
+                *pos = bucket.back();
+                bucket.pop_back();
+            }
+        }
+        entry.hash = hash;
+        for (int k = 0; k < CHUNKS; ++k) {
+            tables[k][chunk(hash, k)].push_back(it->second);
+        }
+        return;
+    }
+
+    uint32_t position = static_cast<uint32_t>(entries.size());
+    entries.push_back({id, hash});
+    positions.emplace(id, position);
+    for (int k = 0; k < CHUNKS; ++k) {
+        tables[k][chunk(hash, k)].push_back(position);
+    }
+}
+
+bool MultiIndexHash::find(int id, uint64_t& hash) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = positions.find(id);
+    if (it == positions.end()) {
+        return false;
+    }
+    hash = entries[it->second].hash;
+    return true;
+}
+
+size_t MultiIndexHash::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+std::vector<SimilarMatch> MultiIndexHash::query(uint64_t hash, int max_distance, size_t limit, int exclude_id) const {
+    std::vector<SimilarMatch> matches;
+    max_distance = std::clamp(max_distance, 0, MAX_DISTANCE);
+    // Радіуси частин з сумою (radius + 1) = max_distance + 1: якби кожна частина
+    // відрізнялась більше за свій радіус, повна відстань перевищила б max_distance.
+    // Радіус -1 означає, що частина не перебирається
+    int radius[CHUNKS];
+    for (int k = 0; k < CHUNKS; ++k) {
+        radius[k] = (max_distance + 1) / CHUNKS + (k < (max_distance + 1) % CHUNKS ? 1 : 0) - 1;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    for (int k = 0; k < CHUNKS; ++k) {
+        const uint32_t key = chunk(hash, k);
+
+        // Усі 16-бітні маски з 0..radius[k] встановленими бітами (Gosper's hack)
+        for (int bits = 0; bits <= radius[k]; ++bits) {
+            uint32_t mask = (1u << bits) - 1;
+            while (mask < (1u << CHUNK_BITS)) {
+                for (uint32_t position : tables[k][key ^ mask]) {
+                    const Entry& entry = entries[position];
+                    if (entry.id == exclude_id) {
+                        continue;
+                    }
+                    // Запис уже знайдено через одну з попередніх частин
+                    bool seen = false;
+                    for (int j = 0; j < k && !seen; ++j) {
+                        seen = __builtin_popcount(chunk(entry.hash, j) ^ chunk(hash, j)) <= radius[j];
+                    }
+                    if (seen) {
+                        continue;
+                    }
+                    int distance = __builtin_popcountll(entry.hash ^ hash);
+                    if (distance <= max_distance) {
+                        matches.push_back({entry.id, distance});
+                    }
+                }
+
+                if (mask == 0) {
+                    break;
+                }
+                uint32_t lowest = mask & -mask;
+                uint32_t ripple = mask + lowest;
+                mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+            }
+        }
+    }
+    lock.unlock();
+
+    std::sort(matches.begin(), matches.end(), [](const SimilarMatch& a, const SimilarMatch& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.id < b.id;
+    });
+    if (matches.size() > limit) {
+        matches.resize(limit);
+    }
+    return matches;
+}
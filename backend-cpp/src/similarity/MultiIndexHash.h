@@ -0,0 +1,50 @@
+#ifndef MULTI_INDEX_HASH_H
+#define MULTI_INDEX_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+struct SimilarMatch {
+    int id;
+    int distance;  // відстань Хеммінга між хешами
+};
+
+// Multi-index hashing для 64-бітних перцептивних хешів: хеш ділиться на 4
+// частини по 16 біт, кожна частина індексує власну таблицю з 65536 кошиків.
+// Якщо повна відстань <= r, то хоча б одна частина відрізняється не більше ніж
+// приблизно на r/4 біт, тож запит перебирає лише сусідні кошики замість усіх хешів
+class MultiIndexHash {
+public:
+    static constexpr int CHUNKS = 4;
+    static constexpr int CHUNK_BITS = 16;
+    static constexpr int MAX_DISTANCE = 16;
+
+    MultiIndexHash();
+
+    // Додає або оновлює хеш зображення
+    void insert(int id, uint64_t hash);
+    bool find(int id, uint64_t& hash) const;
+    // Схожі хеші з відстанню <= max_distance, найближчі першими
+    std::vector<SimilarMatch> query(uint64_t hash, int max_distance, size_t limit, int exclude_id) const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        int id;
+        uint64_t hash;
+    };
+
+    std::vector<Entry> entries;
+    std::unordered_map<int, uint32_t> positions;  // id -> індекс у entries
+    std::vector<std::vector<uint32_t>> tables[CHUNKS];
+    mutable std::shared_mutex mutex;
+
+    static uint32_t chunk(uint64_t hash, int index) {
+        return static_cast<uint32_t>((hash >> (index * CHUNK_BITS)) & 0xFFFF);
+    }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "SimilarityIndex.h"
+#include <iostream>
+#include <chrono>
+
+SimilarityIndex::SimilarityIndex(const DatabaseConfig& db_config, const SimilarityConfig& similarity_config)
+    : db_config(db_config), config(similarity_config), loaded(false), stopping(false) {
+}
+
+SimilarityIndex::~SimilarityIndex() {
+    stop();
+}
+
+void SimilarityIndex::start() {
+    if (!config.enabled || worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    worker = std::thread(&SimilarityIndex::loop, this);
+}
+
+void SimilarityIndex::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void SimilarityIndex::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        poll();
+        lock.lock();
+        wake.wait_for(lock, std::chrono::seconds(config.poll_interval_seconds), [this]() { return stopping; });
+    }
+    connection.reset();
+}
+
+void SimilarityIndex::poll() {
+    try {
+        if (!connection || !connection->is_open()) {
+            connection = std::make_unique<pqxx::connection>(db_config.getConnectionString());
+        }
+
+        pqxx::nontransaction txn(*connection);
+        pqxx::result result;
+        if (cursor.empty()) {
+            result = txn.exec(R"(
+                SELECT id, phash, (MAX(phash_at) OVER ())::TEXT
+                FROM images WHERE phash IS NOT NULL
+            )");
+        } else {
+            // Перекриття на випадок транзакцій, що зафіксувалися пізніше за свій phash_at;
+            // повторна вставка того ж хешу нічого не змінює
+            result = txn.exec_params(R"(
+                SELECT id, phash, (MAX(phash_at) OVER ())::TEXT
+                FROM images
+                WHERE phash IS NOT NULL AND phash_at > $1::TIMESTAMP - INTERVAL '5 seconds'
+            )", cursor);
+        }
+
+        for (const auto& row : result) {
+            index.insert(row[0].as<int>(), static_cast<uint64_t>(row[1].as<int64_t>()));
+        }
+        if (!result.empty()) {
+            cursor = result[0][2].as<std::string>();
+        }
+
+        if (!loaded.exchange(true, std::memory_order_release)) {
+            std::cout << "Індекс схожих зображень завантажено: " << index.size() << " хешів" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Помилка оновлення індексу схожих зображень: " << e.what() << std::endl;
+        connection.reset();
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef SIMILARITY_INDEX_H
+#define SIMILARITY_INDEX_H
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "MultiIndexHash.h"
+#include "../config/Config.h"
+
+// Перцептивні хеші зображень у пам'яті. Фоновий потік спочатку завантажує всі
+// хеші, далі періодично підхоплює нові за images.phash_at (окреме з'єднання)
+class SimilarityIndex {
+private:
+    DatabaseConfig db_config;
+    SimilarityConfig config;
+    MultiIndexHash index;
+    std::unique_ptr<pqxx::connection> connection;
+    std::string cursor;  // найбільший побачений phash_at (текст timestamp)
+    std::atomic<bool> loaded;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void loop();
+    void poll();
+
+public:
+    SimilarityIndex(const DatabaseConfig& db_config, const SimilarityConfig& similarity_config);
+    ~SimilarityIndex();
+
+    void start();
+    void stop();
+
+    // true після першого повного завантаження
+    bool ready() const { return loaded.load(std::memory_order_acquire); }
+    int defaultMaxDistance() const { return config.default_max_distance; }
+    bool findHash(int image_id, uint64_t& hash) const { return index.find(image_id, hash); }
+    std::vector<SimilarMatch> findSimilar(uint64_t hash, int max_distance, size_t limit, int exclude_id) const {
+        return index.query(hash, max_distance, limit, exclude_id);
+    }
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef SPAN_RING_H
+#define SPAN_RING_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace tracing {
+
+// Завершений спан у форматі фіксованого розміру (без алокацій на гарячому шляху)
+struct SpanRecord {
+    uint64_t trace_id_hi = 0;
+    uint64_t trace_id_lo = 0;
+    uint64_t span_id = 0;
+    uint64_t parent_span_id = 0;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    char name[64] = {0};
+    // Один необов'язковий числовий атрибут (ключ - рядковий літерал)
+    const char* attribute_key = nullptr;
+    int64_t attribute_value = 0;
+    bool error = false;
+    bool server = false;  // кореневий спан вхідного запиту
+};
+
+// Обмежений lock-free кільцевий буфер (багато виробників, один споживач).
+// Якщо буфер заповнений, спан відкидається - запит ніколи не блокується
+class SpanRing {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        SpanRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+    alignas(64) std::atomic<uint64_t> dropped;
+
+public:
+    // Ємність округлюється вгору до степеня двійки
+    explicit SpanRing(size_t capacity);
+
+    bool push(const SpanRecord& record);
+    bool pop(SpanRecord& record);
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+}
+
+#endif
@@ -0,0 +1,281 @@
+#include "Tracer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace tracing {
+
+namespace {
+
+thread_local SpanContext current_context;
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string hex64(uint64_t value) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+    return buf;
+}
+
+bool parseHex64(const std::string& text, uint64_t& value) {
+    if (text.size() != 16 || text.find_first_not_of("0123456789abcdef") != std::string::npos) {
+        return false;
+    }
+    value = std::stoull(text, nullptr, 16);
+    return true;
+}
+
+void writeJsonString(std::ostream& out, const char* value) {
+    out << '"';
+    for (const char* p = value; *p; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out << buf;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}
+
+std::string SpanContext::traceIdHex() const {
+    return hex64(trace_id_hi) + hex64(trace_id_lo);
+}
+
+std::string SpanContext::toTraceparent() const {
+    return "00-" + traceIdHex() + "-" + hex64(span_id) + "-01";
+}
+
+SpanContext SpanContext::fromTraceparent(const std::string& header) {
+    SpanContext context;
+    // 00-<32 hex>-<16 hex>-<2 hex>
+    if (header.size() < 55 || header[2] != '-' || header[35] != '-' || header[52] != '-') {
+        return context;
+    }
+    uint64_t hi, lo, span;
+    if (!parseHex64(header.substr(3, 16), hi) || !parseHex64(header.substr(19, 16), lo) ||
+        !parseHex64(header.substr(36, 16), span)) {
+        return context;
+    }
+    context.trace_id_hi = hi;
+    context.trace_id_lo = lo;
+    context.span_id = span;
+    return context;
+}
+
+Tracer::Tracer()
+    : enabled_flag(false), flush_interval_ms(1000), stopping(false) {
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::start(const TracingConfig& config) {
+    if (!config.enabled) {
+        return;
+    }
+    ring = std::make_unique<SpanRing>(config.buffer_size);
+    output_path = config.output_path;
+    service_name = config.service_name;
+    flush_interval_ms = config.flush_interval_ms;
+    stopping = false;
+    exporter = std::thread(&Tracer::exportLoop, this);
+    enabled_flag.store(true, std::memory_order_release);
+    std::cout << "Трасування увімкнене, експорт у " << output_path << std::endl;
+}
+
+void Tracer::stop() {
+    if (!enabled()) {
+        return;
+    }
+    enabled_flag.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (exporter.joinable()) {
+        exporter.join();
+    }
+}
+
+void Tracer::record(const SpanRecord& record) {
+    if (ring) {
+        ring->push(record);
+    }
+}
+
+void Tracer::exportLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+    lock.unlock();
+    flush();
+}
+
+void Tracer::flush() {
+    std::vector<SpanRecord> batch;
+    SpanRecord record;
+    while (ring->pop(record)) {
+        batch.push_back(record);
+    }
+    if (batch.empty()) {
+        return;
+    }
+
+    std::ostringstream json;
+    json << R"({"resourceSpans":[{"resource":{"attributes":[{"key":"service.name","value":{"stringValue":)";
+    writeJsonString(json, service_name.c_str());
+    json << R"(}}]},"scopeSpans":[{"scope":{"name":"backend-cpp"},"spans":[)";
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const SpanRecord& span = batch[i];
+        if (i > 0) {
+            json << ',';
+        }
+        json << R"({"traceId":")" << hex64(span.trace_id_hi) << hex64(span.trace_id_lo) << '"'
+             << R"(,"spanId":")" << hex64(span.span_id) << '"'
+             << R"(,"parentSpanId":")" << (span.parent_span_id ? hex64(span.parent_span_id) : "") << '"'
+             << R"(,"name":)";
+        writeJsonString(json, span.name);
+        json << R"(,"kind":)" << (span.server ? 2 : 1)
+             << R"(,"startTimeUnixNano":")" << span.start_ns << '"'
+             << R"(,"endTimeUnixNano":")" << span.end_ns << '"';
+        if (span.attribute_key) {
+            json << R"(,"attributes":[{"key":)";
+            writeJsonString(json, span.attribute_key);
+            json << R"(,"value":{"intValue":")" << span.attribute_value << R"("}}])";
+        }
+        json << R"(,"status":{"code":)" << (span.error ? 2 : 1) << "}}";
+    }
+    json << "]}]}]}\n";
+
+    std::ofstream out(output_path, std::ios::app);
+    if (!out) {
+        std::cerr << "Не вдалося записати трасування в " << output_path << std::endl;
+        return;
+    }
+    out << json.str();
+
+    uint64_t dropped = ring->droppedCount();
+    if (dropped > 0) {
+        std::cerr << "Трасування: відкинуто спанів через переповнення буфера: " << dropped << std::endl;
+    }
+}
+
+SpanContext Tracer::current() {
+    return current_context;
+}
+
+void Tracer::setCurrent(const SpanContext& context) {
+    current_context = context;
+}
+
+uint64_t Tracer::randomId() {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    uint64_t id;
+    do {
+        id = generator();
+    } while (id == 0);
+    return id;
+}
+
+Span::Span(const char* name)
+    : active(Tracer::instance().enabled()) {
+    if (!active) {
+        return;
+    }
+    parent = current_context;
+    if (parent.valid()) {
+        record.trace_id_hi = parent.trace_id_hi;
+        record.trace_id_lo = parent.trace_id_lo;
+        record.parent_span_id = parent.span_id;
+    } else {
+        record.trace_id_hi = Tracer::randomId();
+        record.trace_id_lo = Tracer::randomId();
+    }
+    record.span_id = Tracer::randomId();
+    std::strncpy(record.name, name, sizeof(record.name) - 1);
+    record.start_ns = nowNanos();
+    current_context = context();
+}
+
+Span::Span(const std::string& name, const SpanContext& remote_parent)
+    : active(Tracer::instance().enabled()) {
+    if (!active) {
+        return;
+    }
+    parent = current_context;
+    if (remote_parent.valid()) {
+        record.trace_id_hi = remote_parent.trace_id_hi;
+        record.trace_id_lo = remote_parent.trace_id_lo;
+        record.parent_span_id = remote_parent.span_id;
+    } else {
+        record.trace_id_hi = Tracer::randomId();
+        record.trace_id_lo = Tracer::randomId();
+    }
+    record.span_id = Tracer::randomId();
+    std::strncpy(record.name, name.c_str(), sizeof(record.name) - 1);
+    record.server = true;
+    record.start_ns = nowNanos();
+    current_context = context();
+}
+
+Span::~Span() {
+    if (!active) {
+        return;
+    }
+    record.end_ns = nowNanos();
+    Tracer::instance().record(record);
+    current_context = parent;
+}
+
+void Span::setAttribute(const char* key, int64_t value) {
+    record.attribute_key = key;
+    record.attribute_value = value;
+}
+
+void Span::setError() {
+    record.error = true;
+}
+
+SpanContext Span::context() const {
+    SpanContext context;
+    if (active) {
+        context.trace_id_hi = record.trace_id_hi;
+        context.trace_id_lo = record.trace_id_lo;
+        context.span_id = record.span_id;
+    }
+    return context;
+}
+
+ScopedContext::ScopedContext(const SpanContext& context)
+    : previous(current_context) {
+    current_context = context;
+}
+
+ScopedContext::~ScopedContext() {
+    current_context = previous;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include "SpanRing.h"
+#include "../config/Config.h"
+
+namespace tracing {
+
+// Контекст трасування поточного потоку
+struct SpanContext {
+    uint64_t trace_id_hi = 0;
+    uint64_t trace_id_lo = 0;
+    uint64_t span_id = 0;
+
+    bool valid() const { return trace_id_hi != 0 || trace_id_lo != 0; }
+    std::string traceIdHex() const;
+    // W3C traceparent: 00-<trace_id>-<span_id>-01
+    std::string toTraceparent() const;
+    static SpanContext fromTraceparent(const std::string& header);
+};
+
+// Збирає завершені спани в кільцевий буфер і періодично скидає їх
+// у файл у форматі OTLP/JSON (по одному ExportTraceServiceRequest на рядок)
+class Tracer {
+private:
+    std::atomic<bool> enabled_flag;
+    std::unique_ptr<SpanRing> ring;
+    std::string output_path;
+    std::string service_name;
+    int flush_interval_ms;
+
+    std::thread exporter;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    Tracer();
+    void exportLoop();
+    void flush();
+
+public:
+    static Tracer& instance();
+
+    bool enabled() const { return enabled_flag.load(std::memory_order_relaxed); }
+    void start(const TracingConfig& config);
+    void stop();
+    void record(const SpanRecord& record);
+
+    // Контекст поточного потоку
+    static SpanContext current();
+    static void setCurrent(const SpanContext& context);
+    static uint64_t randomId();
+};
+
+// RAII спан: дочірній до поточного контексту потоку, на час життя стає поточним.
+// Якщо трасування вимкнене, конструктор і деструктор - лише перевірка прапорця
+class Span {
+private:
+    bool active;
+    SpanContext parent;
+    SpanRecord record;
+
+public:
+    explicit Span(const char* name);
+    // Кореневий спан запиту з можливим батьком із заголовка traceparent
+    Span(const std::string& name, const SpanContext& remote_parent);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void setAttribute(const char* key, int64_t value);
+    void setError();
+    SpanContext context() const;
+};
+
+// Встановлює переданий контекст для фонової роботи в іншому потоці
+class ScopedContext {
+private:
+    SpanContext previous;
+
+public:
+    explicit ScopedContext(const SpanContext& context);
+    ~ScopedContext();
+
+    ScopedContext(const ScopedContext&) = delete;
+    ScopedContext& operator=(const ScopedContext&) = delete;
+};
+
+}
+
+#endif
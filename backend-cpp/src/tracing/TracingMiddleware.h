@@ -0,0 +1,37 @@
+#ifndef TRACING_MIDDLEWARE_H
+#define TRACING_MIDDLEWARE_H
+
+#include "crow.h"
+#include "Tracer.h"
+#include <memory>
+
+// Crow middleware: кореневий спан на кожен запит, trace id приймається
+// із заголовка traceparent і повертається у відповіді
+struct TracingMiddleware {
+    struct context {
+        std::unique_ptr<tracing::Span> span;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!tracing::Tracer::instance().enabled()) {
+            return;
+        }
+        auto remote = tracing::SpanContext::fromTraceparent(req.get_header_value("traceparent"));
+        ctx.span = std::make_unique<tracing::Span>(
+            std::string(crow::method_name(req.method)) + " " + req.url, remote);
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!ctx.span) {
+            return;
+        }
+        ctx.span->setAttribute("http.status_code", res.code);
+        if (res.code >= 500) {
+            ctx.span->setError();
+        }
+        res.set_header("traceparent", ctx.span->context().toTraceparent());
+        ctx.span.reset();
+    }
+};
+
+#endif
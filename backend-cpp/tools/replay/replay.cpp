@@ -0,0 +1,361 @@
+// Відтворення журналу запитів (RecordingMiddleware) проти тестового екземпляра.
+// Розклад відкритий (open-loop): запит надсилається у свій час незалежно від того,
+// чи відповіли попередні, тож повільний сервер не сповільнює навантаження.
+// Затримка рахується від запланованого часу, а не від фактичного надсилання.
+//
+//   replay <journal.rec> <base_url> [--speed 10] [--max-in-flight 1024] [--timeout-ms 30000]
+
+#include "../../src/recording/RecordFormat.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Request {
+    uint64_t offset_us;
+    recording::RecordView record;
+    std::string route;
+};
+
+struct Transfer {
+    const Request* request = nullptr;
+    CURL* easy = nullptr;
+    curl_slist* headers = nullptr;
+    std::string body;
+    Clock::time_point scheduled;
+    Clock::time_point sent;
+};
+
+struct RouteStats {
+    std::vector<double> latency_ms;
+    std::vector<double> recorded_ms;
+    size_t status_2xx = 0;
+    size_t status_4xx = 0;
+    size_t status_5xx = 0;
+    size_t errors = 0;     // таймаут, відмова з'єднання
+};
+
+bool isIdSegment(const std::string& segment) {
+    if (segment.empty()) {
+        return false;
+    }
+    if (segment.find_first_not_of("0123456789") == std::string::npos) {
+        return true;
+    }
+    return segment.size() >= 16 &&
+           segment.find_first_not_of("0123456789abcdefABCDEF-_") == std::string::npos;
+}
+
+// Шаблон маршруту для групування: без query, ідентифікатори замінені на :id
+std::string routeOf(uint8_t method, const std::string& url) {
+    std::string path = url.substr(0, url.find('?'));
+    std::string route = std::string(recording::methodName(method)) + " ";
+    std::stringstream segments(path);
+    std::string segment;
+    bool first = true;
+    while (std::getline(segments, segment, '/')) {
+        if (first) {
+            first = false;
+            continue;
+        }
+        route += "/";
+        route += isIdSegment(segment) ? ":id" : segment;
+    }
+    return route;
+}
+
+std::string headerValue(const std::string& headers, const std::string& name) {
+    std::stringstream lines(headers);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, name.size() + 2, name + ": ") == 0) {
+            return line.substr(name.size() + 2);
+        }
+    }
+    return "";
+}
+
+// Тіло того ж розміру замість не збереженого. Для multipart - валідна форма
+// з тим самим boundary, щоб сервер пройшов розбір і обробку файлу
+std::string syntheticBody(const std::string& content_type, size_t size) {
+    const std::string marker = "boundary=";
+    size_t pos = content_type.find(marker);
+    if (content_type.compare(0, 19, "multipart/form-data") != 0 || pos == std::string::npos) {
+        return std::string(size, 'x');
+    }
+    std::string boundary = content_type.substr(pos + marker.size());
+    if (boundary.size() >= 2 && boundary.front() == '"' && boundary.back() == '"') {
+        boundary = boundary.substr(1, boundary.size() - 2);
+    }
+
+    std::string head =
+        "--" + boundary + "\r\nContent-Disposition: form-data; name=\"name\"\r\n\r\nreplay\r\n"
+        "--" + boundary + "\r\nContent-Disposition: form-data; name=\"description\"\r\n\r\n\r\n"
+        "--" + boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"replay.jpg\"\r\n"
+        "Content-Type: image/jpeg\r\n\r\n";
+    std::string tail = "\r\n--" + boundary + "--\r\n";
+    size_t envelope = head.size() + tail.size();
+    return head + std::string(size > envelope ? size - envelope : 0, 'x') + tail;
+}
+
+size_t discard(char*, size_t size, size_t count, void*) {
+    return size * count;
+}
+
+std::unique_ptr<Transfer> startTransfer(CURLM* multi, const std::string& base_url, const Request& request,
+                                        Clock::time_point scheduled, long timeout_ms) {
+    auto transfer = std::make_unique<Transfer>();
+    const recording::RecordView& record = request.record;
+    transfer->request = &request;
+    transfer->scheduled = scheduled;
+
+    std::string url = base_url + std::string(record.url, record.header.url_len);
+    std::string headers(record.headers, record.header.headers_len);
+    std::string method = recording::methodName(record.header.method);
+
+    if (record.body) {
+        transfer->body.assign(record.body, record.header.body_size);
+    } else if (record.header.body_kind == static_cast<uint8_t>(recording::BodyKind::Synthetic)) {
+        transfer->body = syntheticBody(headerValue(headers, "Content-Type"), record.header.body_size);
+    }
+
+    std::stringstream lines(headers);
+    std::string line;
+    while (std::getline(lines, line)) {
+        transfer->headers = curl_slist_append(transfer->headers, line.c_str());
+    }
+    // Без очікування 100-continue перед великими тілами
+    transfer->headers = curl_slist_append(transfer->headers, "Expect:");
+
+    CURL* easy = curl_easy_init();
+    transfer->easy = easy;
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, discard);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+    if (method == "HEAD") {
+        curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+    } else if (method != "GET") {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, method.c_str());
+    }
+    if (!transfer->body.empty() || method == "POST") {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer->body.size()));
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, transfer->body.data());
+    }
+
+    transfer->sent = Clock::now();
+    curl_multi_add_handle(multi, easy);
+    return transfer;
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void printReport(std::map<std::string, RouteStats>& stats, double max_send_lag_ms, double duration_s) {
+    std::vector<std::pair<std::string, RouteStats*>> routes;
+    size_t total = 0;
+    for (auto& entry : stats) {
+        routes.emplace_back(entry.first, &entry.second);
+        total += entry.second.latency_ms.size();
+    }
+    std::sort(routes.begin(), routes.end(), [](const auto& a, const auto& b) {
+        return a.second->latency_ms.size() > b.second->latency_ms.size();
+    });
+
+    std::printf("\n%-40s %7s %6s %6s %6s %5s %9s %9s %9s %9s %9s %9s\n", "route", "count", "2xx", "4xx", "5xx",
+                "err", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms", "rec p99");
+    for (auto& route : routes) {
+        RouteStats& s = *route.second;
+        std::printf("%-40s %7zu %6zu %6zu %6zu %5zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                    route.first.c_str(), s.latency_ms.size(), s.status_2xx, s.status_4xx, s.status_5xx, s.errors,
+                    percentile(s.latency_ms, 0.50), percentile(s.latency_ms, 0.90),
+                    percentile(s.latency_ms, 0.99), percentile(s.latency_ms, 0.999),
+                    percentile(s.latency_ms, 1.0), percentile(s.recorded_ms, 0.99));
+    }
+    std::printf("\n%zu запитів за %.1f с (%.1f/с), найбільше запізнення надсилання %.1f мс\n",
+                total, duration_s, duration_s > 0 ? total / duration_s : 0.0, max_send_lag_ms);
+    if (max_send_lag_ms > 100.0) {
+        std::printf("Генератор не встигав за розкладом - збільште --max-in-flight або зменште --speed\n");
+    }
+}
+
+void usage() {
+    std::cerr << "Використання: replay <journal.rec> <base_url> [--speed N] [--max-in-flight N] [--timeout-ms N]"
+              << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    std::string journal_path = argv[1];
+    std::string base_url = argv[2];
+    while (!base_url.empty() && base_url.back() == '/') {
+        base_url.pop_back();
+    }
+    double speed = 1.0;
+    size_t max_in_flight = 1024;
+    long timeout_ms = 30000;
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        try {
+            if (option == "--speed") {
+                speed = std::stod(argv[i + 1]);
+            } else if (option == "--max-in-flight") {
+                max_in_flight = std::stoul(argv[i + 1]);
+            } else if (option == "--timeout-ms") {
+                timeout_ms = std::stol(argv[i + 1]);
+            } else {
+                usage();
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Некоректне значення " << option << ": " << argv[i + 1] << std::endl;
+            return 1;
+        }
+    }
+    if (speed <= 0.0 || max_in_flight == 0) {
+        usage();
+        return 1;
+    }
+
+    std::ifstream in(journal_path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Не вдалося відкрити " << journal_path << std::endl;
+        return 1;
+    }
+    std::string journal((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const char* p = journal.data();
+    const char* end = p + journal.size();
+    recording::FileHeader file_header;
+    if (!recording::readFileHeader(p, end, file_header)) {
+        std::cerr << "Невідомий формат журналу " << journal_path << std::endl;
+        return 1;
+    }
+
+    std::vector<Request> requests;
+    recording::RecordView record;
+    while (recording::readRecord(p, end, record)) {
+        // Preflight CORS не несе навантаження на обробники
+        if (record.header.method == static_cast<uint8_t>(recording::Method::Options)) {
+            continue;
+        }
+        requests.push_back({record.header.offset_us, record,
+                            routeOf(record.header.method, std::string(record.url, record.header.url_len))});
+    }
+    if (p != end) {
+        std::cerr << "Останній запис обрізаний, пропущено " << (end - p) << " байт" << std::endl;
+    }
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.offset_us < b.offset_us;
+    });
+    if (requests.empty()) {
+        std::cerr << "Журнал порожній" << std::endl;
+        return 1;
+    }
+    std::cout << "Відтворення " << requests.size() << " запитів з " << journal_path << " на " << base_url
+              << " зі швидкістю " << speed << "x" << std::endl;
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    CURLM* multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(max_in_flight));
+
+    std::map<std::string, RouteStats> stats;
+    std::map<CURL*, std::unique_ptr<Transfer>> in_flight;
+    double max_send_lag_ms = 0.0;
+    size_t next = 0;
+    auto start = Clock::now();
+    uint64_t first_offset = requests.front().offset_us;
+
+    auto scheduledAt = [&](const Request& request) {
+        double offset_us = (request.offset_us - first_offset) / speed;
+        return start + std::chrono::microseconds(static_cast<int64_t>(offset_us));
+    };
+
+    while (next < requests.size() || !in_flight.empty()) {
+        auto now = Clock::now();
+        while (next < requests.size() && in_flight.size() < max_in_flight && scheduledAt(requests[next]) <= now) {
+            auto scheduled = scheduledAt(requests[next]);
+            auto transfer = startTransfer(multi, base_url, requests[next], scheduled, timeout_ms);
+            max_send_lag_ms = std::max(max_send_lag_ms,
+                std::chrono::duration<double, std::milli>(transfer->sent - scheduled).count());
+            CURL* easy = transfer->easy;
+            in_flight.emplace(easy, std::move(transfer));
+            ++next;
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &queued)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL* easy = message->easy_handle;
+            auto it = in_flight.find(easy);
+            Transfer& transfer = *it->second;
+            auto finished = Clock::now();
+
+            RouteStats& route = stats[transfer.request->route];
+            route.latency_ms.push_back(std::chrono::duration<double, std::milli>(finished - transfer.scheduled).count());
+            route.recorded_ms.push_back(transfer.request->record.header.latency_us / 1000.0);
+            long code = 0;
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+            if (message->data.result != CURLE_OK || code == 0) {
+                ++route.errors;
+            } else if (code >= 500) {
+                ++route.status_5xx;
+            } else if (code >= 400) {
+                ++route.status_4xx;
+            } else {
+                ++route.status_2xx;
+            }
+
+            curl_multi_remove_handle(multi, easy);
+            curl_easy_cleanup(easy);
+            curl_slist_free_all(transfer.headers);
+            in_flight.erase(it);
+        }
+
+        // Чекаємо на мережу, але не довше ніж до наступного запланованого запиту
+        int wait_ms = 100;
+        if (next < requests.size() && in_flight.size() < max_in_flight) {
+            auto until = std::chrono::duration_cast<std::chrono::milliseconds>(scheduledAt(requests[next]) - Clock::now());
+            wait_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(wait_ms, until.count())));
+        }
+        curl_multi_poll(multi, nullptr, 0, wait_ms, nullptr);
+    }
+
+    double duration_s = std::chrono::duration<double>(Clock::now() - start).count();
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
+
+    printReport(stats, max_send_lag_ms, duration_s);
+    return 0;
+}
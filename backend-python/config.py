@@ -1,4 +1,5 @@
 import os
+import socket
 
 # Database config
 DB_CONFIG = {
@@ -16,4 +17,44 @@ R2_CONFIG = {
     'secret_access_key': os.getenv('R2_SECRET_KEY', 'your_secret_key'),
     'bucket_name': os.getenv('R2_BUCKET', 'images'),
     'region_name': os.getenv('R2_REGION', 'auto')
-}
\ No newline at end of file
+}
+
+# Scheduler config
+SCHEDULER_CONFIG = {
+    # додатковий пріоритет для типів обробки (більше - раніше)
+    'type_priority': {
+        'invert': int(os.getenv('PRIORITY_INVERT', '1')),
+        'grayscale': int(os.getenv('PRIORITY_GRAYSCALE', '1')),
+    },
+    # на скільки секунд оцінки зменшується вартість за кожну секунду очікування
+    'aging_rate': float(os.getenv('SCHEDULER_AGING_RATE', '0.05')),
+    # після цього часу очікування завдання обробляється поза чергою
+    'max_wait_seconds': int(os.getenv('SCHEDULER_MAX_WAIT', '600')),
+    'cost_refresh_seconds': int(os.getenv('SCHEDULER_COST_REFRESH', '300')),
+    'cost_history_days': int(os.getenv('SCHEDULER_COST_HISTORY_DAYS', '7')),
+    'batch_size': int(os.getenv('SCHEDULER_BATCH_SIZE', '500')),
+}
+
+# Perceptual hash config
+PHASH_CONFIG = {
+    # скільки зображень без хешу обробляти за одну ітерацію циклу
+    'batch_size': int(os.getenv('PHASH_BATCH_SIZE', '50')),
+    # пауза перед повторним завантаженням оригіналу після невдачі (подвоюється до max)
+    'retry_seconds': int(os.getenv('PHASH_RETRY_SECONDS', '300')),
+    'max_retry_seconds': int(os.getenv('PHASH_MAX_RETRY_SECONDS', '86400')),
+}
+
+# Worker config
+WORKER_CONFIG = {
+    # унікальний ідентифікатор процесу обробника (власник оренди завдань)
+    'worker_id': os.getenv('WORKER_ID', f"{socket.gethostname()}-{os.getpid()}"),
+    # оренда завдання; heartbeat продовжує її, поки завдання обробляється
+    'lease_seconds': int(os.getenv('WORKER_LEASE_SECONDS', '60')),
+    'heartbeat_seconds': int(os.getenv('WORKER_HEARTBEAT_SECONDS', '20')),
+    # після стількох спроб завдання переходить у статус dead
+    'max_attempts': int(os.getenv('WORKER_MAX_ATTEMPTS', '3')),
+    # скільки завдань одного зображення брати разом (оригінал декодується один раз)
+    'max_group_size': int(os.getenv('WORKER_MAX_GROUP_SIZE', '16')),
+    # потоки для паралельних обробок, кодування і завантажень однієї групи
+    'fanout_threads': int(os.getenv('WORKER_FANOUT_THREADS', str(os.cpu_count() or 4))),
+}
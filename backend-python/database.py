@@ -4,72 +4,263 @@ from config import DB_CONFIG
 def get_db_connection():
     return psycopg2.connect(**DB_CONFIG)
 
-def get_processing_tasks():
-    
+def get_pending_tasks(limit=500, max_attempts=3):
+    """Кандидати на обробку: очікують або мають прострочену оренду
+    (обробник, що їх взяв, зупинився). Саме взяття - claim_task"""
     conn = get_db_connection()
     cursor = conn.cursor()
     
     query = """
-    SELECT t.id as task_id, t.image_id, t.processing_type, i.filename
+    SELECT t.id as task_id, t.image_id, t.processing_type, i.filename,
+           t.priority, i.size_bytes, t.trace_id, t.output_options, t.attempts,
+           i.phash IS NULL AND i.phash_at IS NULL AS needs_phash,
+           EXTRACT(EPOCH FROM (NOW() - t.created_at))::float AS age_seconds
     FROM tasks t 
     JOIN images i ON t.image_id = i.id 
-    WHERE t.status = 'processing'
+    WHERE t.status = 'pending'
+       OR (t.status = 'processing' AND COALESCE(t.lease_expires_at, '-infinity') < NOW()
+           AND t.attempts < %s)
+    ORDER BY t.created_at
+    LIMIT %s
     """
     
-    cursor.execute(query)
+    cursor.execute(query, (max_attempts, limit))
     tasks = cursor.fetchall()
     
-
     columns = [desc[0] for desc in cursor.description]
     tasks = [dict(zip(columns, row)) for row in tasks]
     
     cursor.close()
     conn.close()
     
-    print(f"Found {len(tasks)} tasks in processing status (for recovery)")
+    print(f"Found {len(tasks)} pending tasks")
     return tasks
 
-def get_pending_tasks():
+def claim_task(task_id, worker_id, lease_seconds, max_attempts):
+    """Атомарне взяття завдання в оренду. False якщо його вже взяв інший обробник.
+    SKIP LOCKED - не чекаємо на рядок, який саме зараз бере хтось інший"""
     conn = get_db_connection()
     cursor = conn.cursor()
-    
+
     query = """
-    SELECT t.id as task_id, t.image_id, t.processing_type, i.filename
-    FROM tasks t 
-    JOIN images i ON t.image_id = i.id 
-    WHERE t.status = 'pending'
+    UPDATE tasks
+    SET status = 'processing', worker_id = %s, attempts = attempts + 1,
+        lease_expires_at = NOW() + make_interval(secs => %s), started_at = NOW()
+    WHERE id = (
+        SELECT id FROM tasks
+        WHERE id = %s
+          AND (status = 'pending'
+               OR (status = 'processing' AND COALESCE(lease_expires_at, '-infinity') < NOW()
+                   AND attempts < %s))
+        FOR UPDATE SKIP LOCKED
+    )
+    RETURNING id
     """
-    
-    cursor.execute(query)
-    tasks = cursor.fetchall()
-    
-    columns = [desc[0] for desc in cursor.description]
-    tasks = [dict(zip(columns, row)) for row in tasks]
-    
+    cursor.execute(query, (worker_id, lease_seconds, task_id, max_attempts))
+    claimed = cursor.fetchone() is not None
+
+    conn.commit()
     cursor.close()
     conn.close()
-    
-    print(f"Found {len(tasks)} pending tasks")
-    return tasks
 
-def update_task_status(task_id, status, processed_path=None):
+    if claimed:
+        print(f"Claimed task {task_id} as {worker_id}")
+    return claimed
+
+def extend_leases(task_ids, worker_id, lease_seconds):
+    """Heartbeat: продовження оренди. Повертає ID завдань, які досі належать обробнику"""
+    if not task_ids:
+        return set()
     conn = get_db_connection()
     cursor = conn.cursor()
-    
-    if status == "completed":
+
+    query = """
+    UPDATE tasks
+    SET lease_expires_at = NOW() + make_interval(secs => %s)
+    WHERE id = ANY(%s) AND worker_id = %s AND status = 'processing'
+    RETURNING id
+    """
+    cursor.execute(query, (lease_seconds, list(task_ids), worker_id))
+    held = {row[0] for row in cursor.fetchall()}
+
+    conn.commit()
+    cursor.close()
+    conn.close()
+
+    return held
+
+def complete_task(task_id, worker_id, processed_path):
+    """Завершення завдання лише тим обробником, що тримає оренду"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = """
+    UPDATE tasks 
+    SET status = 'completed', completed_at = NOW(), processed_path = %s,
+        worker_id = NULL, lease_expires_at = NULL,
+        duration = (EXTRACT(EPOCH FROM (NOW() - created_at)) || ' seconds')::interval
+    WHERE id = %s AND worker_id = %s
+    """
+    cursor.execute(query, (processed_path, task_id, worker_id))
+    completed = cursor.rowcount > 0
+
+    if completed:
+        # Запам'ятовуємо результат для того ж вмісту оригіналу та типу обробки
         query = """
-        UPDATE tasks 
-        SET status = %s, completed_at = NOW(), 
-            duration = (EXTRACT(EPOCH FROM (NOW() - created_at)) || ' seconds')::interval
-        WHERE id = %s
+        INSERT INTO processing_results (content_hash, processing_type, params, processed_path)
+        SELECT i.checksum, t.processing_type, t.output_options, %s
+        FROM tasks t
+        JOIN images i ON t.image_id = i.id
+        WHERE t.id = %s AND i.checksum IS NOT NULL
+        ON CONFLICT DO NOTHING
         """
-        cursor.execute(query, (status, task_id))
+        cursor.execute(query, (processed_path, task_id))
+
+    conn.commit()
+    cursor.close()
+    conn.close()
+
+    if completed:
+        print(f"Updated task {task_id} to: completed")
     else:
-        query = "UPDATE tasks SET status = %s WHERE id = %s"
-        cursor.execute(query, (status, task_id))
-    
+        print(f"Task {task_id}: оренду втрачено, результат не записано")
+    return completed
+
+def release_failed_task(task_id, worker_id, max_attempts):
+    """Невдала спроба: завдання повертається в чергу, після max_attempts - 'dead'"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = """
+    UPDATE tasks
+    SET status = CASE WHEN attempts >= %s THEN 'dead' ELSE 'pending' END,
+        worker_id = NULL, lease_expires_at = NULL
+    WHERE id = %s AND worker_id = %s
+    RETURNING status
+    """
+    cursor.execute(query, (max_attempts, task_id, worker_id))
+    row = cursor.fetchone()
+
     conn.commit()
     cursor.close()
     conn.close()
-    
-    print(f"Updated task {task_id} to: {status}")
\ No newline at end of file
+
+    status = row[0] if row else None
+    print(f"Updated task {task_id} to: {status}")
+    return status
+
+def bury_exhausted_tasks(max_attempts):
+    """Прострочена оренда після останньої спроби (обробник падав на цьому завданні) -
+    завдання переходить у 'dead' замість нового повтору"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = """
+    UPDATE tasks
+    SET status = 'dead', worker_id = NULL, lease_expires_at = NULL
+    WHERE status = 'processing'
+      AND COALESCE(lease_expires_at, '-infinity') < NOW()
+      AND attempts >= %s
+    RETURNING id
+    """
+    cursor.execute(query, (max_attempts,))
+    buried = [row[0] for row in cursor.fetchall()]
+
+    conn.commit()
+    cursor.close()
+    conn.close()
+
+    for task_id in buried:
+        print(f"Task {task_id}: вичерпано спроби, статус dead")
+    return len(buried)
+
+def set_image_phash(image_id, phash):
+    """Збереження перцептивного хешу. phash=None позначає, що зображення не вдалося
+    декодувати, щоб не повторювати спробу на кожній ітерації"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = "UPDATE images SET phash = %s, phash_at = NOW() WHERE id = %s"
+    cursor.execute(query, (phash, image_id))
+
+    conn.commit()
+    cursor.close()
+    conn.close()
+
+def get_images_without_phash(limit, exclude_ids=()):
+    """Завантажені зображення, для яких ще не обчислено перцептивний хеш.
+    exclude_ids - зображення, повторна спроба для яких ще не настала"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = """
+    SELECT id AS image_id, filename
+    FROM images
+    WHERE phash IS NULL AND phash_at IS NULL
+      AND status NOT IN ('awaiting_upload', 'error')
+      AND id <> ALL(%s::int[])
+    ORDER BY id
+    LIMIT %s
+    """
+    cursor.execute(query, (list(exclude_ids), limit))
+    columns = [desc[0] for desc in cursor.description]
+    images = [dict(zip(columns, row)) for row in cursor.fetchall()]
+
+    cursor.close()
+    conn.close()
+
+    return images
+
+def get_cost_statistics(history_days):
+    """Регресія тривалості обробки від розміру файлу для кожного типу обробки"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    # Для старих завдань без started_at використовується повна тривалість
+    query = """
+    SELECT t.processing_type,
+           regr_intercept(s.seconds, i.size_bytes) AS intercept,
+           regr_slope(s.seconds, i.size_bytes) AS slope,
+           AVG(s.seconds) AS avg_seconds
+    FROM tasks t
+    JOIN images i ON t.image_id = i.id
+    CROSS JOIN LATERAL (
+        SELECT EXTRACT(EPOCH FROM COALESCE(t.completed_at - t.started_at, t.duration))::float AS seconds
+    ) s
+    WHERE t.status = 'completed'
+      AND t.completed_at > NOW() - make_interval(days => %s)
+      AND s.seconds IS NOT NULL
+    GROUP BY t.processing_type
+    """
+
+    cursor.execute(query, (history_days,))
+    rows = cursor.fetchall()
+
+    cursor.close()
+    conn.close()
+
+    return {row[0]: (row[1], row[2], row[3]) for row in rows}
+
+
+def find_cached_result(task_id):
+    """Готовий результат для вмісту оригіналу та типу обробки завдання"""
+    conn = get_db_connection()
+    cursor = conn.cursor()
+
+    query = """
+    SELECT r.processed_path
+    FROM tasks t
+    JOIN images i ON t.image_id = i.id
+    JOIN processing_results r
+      ON r.content_hash = i.checksum AND r.processing_type = t.processing_type
+     AND r.params = t.output_options
+    WHERE t.id = %s
+    """
+
+    cursor.execute(query, (task_id,))
+    row = cursor.fetchone()
+
+    cursor.close()
+    conn.close()
+
+    return row[0] if row else None
@@ -2,6 +2,15 @@ import cv2
 import numpy as np
 import os
 from enum import Enum
+from urllib.parse import parse_qs
+
+# Кандидати якості для режиму "smallest" (від найнижчої)
+SMALLEST_QUALITY_STEPS = [40, 50, 60, 70, 75, 80, 85, 90, 95]
+DEFAULT_MIN_PSNR = 40.0
+# Типова якість JPEG у OpenCV, щоб явні параметри без quality не змінювали результат
+DEFAULT_JPEG_QUALITY = 95
+
+FORMAT_EXTENSIONS = {"jpeg": ".jpg", "png": ".png", "webp": ".webp"}
 
 class ProcessingType(Enum):
     WHITE_BLUE = "white-blue"
@@ -14,48 +23,79 @@ class ProcessingType(Enum):
     BRIGHTNESS = "brightness"
     CONTRAST = "contrast"
 
-def process_image(input_path, output_path, processing_type):
-    """Обробка зображення на основі типу з використанням OpenCV"""
+def process_image(input_path, output_path, processing_type, output_options=""):
+    """Обробка зображення на основі типу з використанням OpenCV.
+    Результат кодується згідно output_options; формат файлу може відрізнятися
+    від розширення output_path (див. detect_extension)"""
     try:
         print(f"Обробка зображення: {input_path} -> {output_path} з типом: {processing_type}")
         
         # Читаємо зображення
-        if not os.path.exists(input_path):
-            print(f"Вхідний файл не знайдено: {input_path}")
-            return False
-            
-        image = cv2.imread(input_path)
+        image = decode_image(input_path)
         if image is None:
-            print(f"Не вдалося прочитати зображення: {input_path}")
             return False
+
+        return process_decoded(image, output_path, processing_type, output_options,
+                               format_from_path(input_path))
         
-        # Обробка на основі типу
-        processed_image = None
-        
-        if processing_type == ProcessingType.WHITE_BLUE.value:
-            processed_image = apply_white_blue_effect(image)
-        elif processing_type == ProcessingType.GRAYSCALE.value:
-            processed_image = apply_grayscale(image)
-        elif processing_type == ProcessingType.BLUR.value:
-            processed_image = apply_blur(image)
-        elif processing_type == ProcessingType.SHARPEN.value:
-            processed_image = apply_sharpen(image)
-        elif processing_type == ProcessingType.EDGE_DETECTION.value:
-            processed_image = apply_edge_detection(image)
-        elif processing_type == ProcessingType.SEPIA.value:
-            processed_image = apply_sepia(image)
-        elif processing_type == ProcessingType.INVERT.value:
-            processed_image = apply_invert(image)
-        elif processing_type == ProcessingType.BRIGHTNESS.value:
-            processed_image = adjust_brightness(image, value=50)
-        elif processing_type == ProcessingType.CONTRAST.value:
-            processed_image = adjust_contrast(image, value=1.5)
-        
-        # Зберігаємо оброблене зображення
-        success = cv2.imwrite(output_path, processed_image)
-        if not success:
-            print(f"Не вдалося зберегти оброблене зображення: {output_path}")
+    except Exception as e:
+        print(f"Помилка обробки зображення: {e}")
+        return False
+
+def decode_image(input_path):
+    """Декодування оригіналу. Результат можна спільно використовувати для кількох
+    обробок: жоден фільтр не змінює вхідний масив"""
+    if not os.path.exists(input_path):
+        print(f"Вхідний файл не знайдено: {input_path}")
+        return None
+
+    image = cv2.imread(input_path)
+    if image is None:
+        print(f"Не вдалося прочитати зображення: {input_path}")
+    return image
+
+def apply_processing(image, processing_type):
+    """Новий масив з результатом обробки; None для невідомого типу"""
+    if processing_type == ProcessingType.WHITE_BLUE.value:
+        return apply_white_blue_effect(image)
+    elif processing_type == ProcessingType.GRAYSCALE.value:
+        return apply_grayscale(image)
+    elif processing_type == ProcessingType.BLUR.value:
+        return apply_blur(image)
+    elif processing_type == ProcessingType.SHARPEN.value:
+        return apply_sharpen(image)
+    elif processing_type == ProcessingType.EDGE_DETECTION.value:
+        return apply_edge_detection(image)
+    elif processing_type == ProcessingType.SEPIA.value:
+        return apply_sepia(image)
+    elif processing_type == ProcessingType.INVERT.value:
+        return apply_invert(image)
+    elif processing_type == ProcessingType.BRIGHTNESS.value:
+        return adjust_brightness(image, value=50)
+    elif processing_type == ProcessingType.CONTRAST.value:
+        return adjust_contrast(image, value=1.5)
+    return None
+
+def process_decoded(image, output_path, processing_type, output_options, default_format):
+    """Обробка вже декодованого зображення, кодування і запис результату.
+    OpenCV відпускає GIL, тож виклики для різних типів можна виконувати паралельно"""
+    try:
+        processed_image = apply_processing(image, processing_type)
+        if processed_image is None:
+            print(f"Невідомий тип обробки: {processing_type}")
+            return False
+
+        # Кодуємо та зберігаємо оброблене зображення
+        if output_options:
+            encoded = encode_output(processed_image, parse_output_options(output_options), default_format)
+        else:
+            encoded = encode_default(processed_image, output_path)
+        if encoded is None:
+            print(f"Не вдалося закодувати оброблене зображення: {output_path}")
             return False
+
+        with open(output_path, "wb") as f:
+            f.write(encoded)
             
         print(f"Успішно оброблено та збережено: {output_path}")
         return True
@@ -64,6 +104,153 @@ def process_image(input_path, output_path, processing_type):
         print(f"Помилка обробки зображення: {e}")
         return False
 
+def parse_output_options(output_options):
+    """Розбір канонічного рядка параметрів кодування з tasks.output_options"""
+    parsed = parse_qs(output_options or "")
+    options = {key: values[0] for key, values in parsed.items()}
+    return {
+        "format": options.get("format"),
+        "quality": int(options["quality"]) if "quality" in options else None,
+        "progressive": options.get("progressive") == "1",
+        "subsampling": options.get("subsampling"),
+        "mode": options.get("mode"),
+        "min_psnr": float(options.get("min_psnr", DEFAULT_MIN_PSNR)),
+    }
+
+def format_from_path(path):
+    ext = os.path.splitext(path)[1].lower()
+    if ext in (".jpg", ".jpeg"):
+        return "jpeg"
+    if ext == ".webp":
+        return "webp"
+    if ext == ".png":
+        return "png"
+    # gif/bmp та інші з явними параметрами: без втрат у png
+    return "png"
+
+def encode_params(fmt, quality, progressive=False, subsampling=None):
+    """Параметри cv2.imencode для формату. OpenCV не переносить EXIF/ICC,
+    тож метадані у результаті завжди видалені"""
+    params = []
+    if fmt == "jpeg":
+        params += [cv2.IMWRITE_JPEG_QUALITY, quality or DEFAULT_JPEG_QUALITY, cv2.IMWRITE_JPEG_OPTIMIZE, 1]
+        if progressive:
+            params += [cv2.IMWRITE_JPEG_PROGRESSIVE, 1]
+        # Субдискретизація доступна з OpenCV 4.5.5
+        sampling = {
+            "444": getattr(cv2, "IMWRITE_JPEG_SAMPLING_FACTOR_444", None),
+            "422": getattr(cv2, "IMWRITE_JPEG_SAMPLING_FACTOR_422", None),
+            "420": getattr(cv2, "IMWRITE_JPEG_SAMPLING_FACTOR_420", None),
+        }.get(subsampling)
+        if sampling is not None and hasattr(cv2, "IMWRITE_JPEG_SAMPLING_FACTOR"):
+            params += [cv2.IMWRITE_JPEG_SAMPLING_FACTOR, sampling]
+    elif fmt == "webp":
+        params += [cv2.IMWRITE_WEBP_QUALITY, quality or 90]
+    elif fmt == "png":
+        # PNG без втрат: максимальне стиснення замість якості
+        params += [cv2.IMWRITE_PNG_COMPRESSION, 9]
+    return params
+
+def encode_with(image, fmt, quality=None, progressive=False, subsampling=None):
+    ok, buffer = cv2.imencode(FORMAT_EXTENSIONS[fmt], image,
+                              encode_params(fmt, quality, progressive, subsampling))
+    return buffer.tobytes() if ok else None
+
+def to_bgr(image):
+    """Зображення у 3 каналах BGR: формати без альфи (JPEG) відкидають її при кодуванні"""
+    if image.ndim == 2:
+        return cv2.cvtColor(image, cv2.COLOR_GRAY2BGR)
+    if image.shape[2] == 4:
+        return cv2.cvtColor(image, cv2.COLOR_BGRA2BGR)
+    return image
+
+def psnr(original, encoded_bytes):
+    decoded = cv2.imdecode(np.frombuffer(encoded_bytes, np.uint8), cv2.IMREAD_UNCHANGED)
+    if decoded is None:
+        return 0.0
+    # Порівнюємо спільні канали: RGBA -> JPEG чи сірий -> кольоровий не є втратою якості
+    original, decoded = to_bgr(original), to_bgr(decoded)
+    if decoded.shape != original.shape or decoded.dtype != original.dtype:
+        return 0.0
+    return cv2.PSNR(original, decoded)
+
+def encode_smallest(image, options, default_format):
+    """Найменший результат серед форматів і якостей, що тримає PSNR >= min_psnr"""
+    formats = [options["format"]] if options["format"] else ["jpeg", "webp", default_format]
+    best = None
+
+    for fmt in dict.fromkeys(formats):
+        if fmt == "png":
+            candidate = encode_with(image, "png")
+            if candidate is not None and (best is None or len(candidate) < len(best)):
+                best = candidate
+            continue
+
+        # Якість монотонно впливає на PSNR, тому перша якість що проходить поріг - найменша
+        for quality in SMALLEST_QUALITY_STEPS:
+            candidate = encode_with(image, fmt, quality, options["progressive"], options["subsampling"])
+            if candidate is None:
+                break
+            if psnr(image, candidate) >= options["min_psnr"]:
+                if best is None or len(candidate) < len(best):
+                    best = candidate
+                break
+
+    # Жоден варіант не пройшов поріг - кодуємо без втрат
+    return best if best is not None else encode_with(image, "png")
+
+def encode_default(image, output_path):
+    """Без параметрів кодування - як раніше cv2.imwrite: формат за розширенням
+    output_path (тобто оригіналу) і типові налаштування OpenCV"""
+    ok, buffer = cv2.imencode(os.path.splitext(output_path)[1], image)
+    return buffer.tobytes() if ok else None
+
+def encode_output(image, options, default_format):
+    if options["mode"] == "smallest":
+        return encode_smallest(image, options, default_format)
+    fmt = options["format"] or default_format
+    return encode_with(image, fmt, options["quality"], options["progressive"], options["subsampling"])
+
+def detect_extension(path, fallback):
+    """Розширення за сигнатурою вмісту (формат може бути обраний під час кодування)"""
+    try:
+        with open(path, "rb") as f:
+            header = f.read(12)
+    except OSError:
+        return fallback
+    if header.startswith(b"\xff\xd8"):
+        # Зберігаємо оригінальне написання (.jpeg/.JPG)
+        return fallback if fallback.lower() in (".jpg", ".jpeg") else ".jpg"
+    if header.startswith(b"\x89PNG"):
+        return ".png"
+    if header.startswith(b"RIFF") and header[8:12] == b"WEBP":
+        return ".webp"
+    return fallback
+
+def compute_dhash(image_path):
+    """64-бітний dHash: зображення 9x8 у відтінках сірого, кожен біт - чи світліший
+    піксель за правого сусіда. Повертає знакове 64-бітне число (BIGINT) або None"""
+    image = cv2.imread(image_path, cv2.IMREAD_GRAYSCALE)
+    if image is None:
+        return None
+    return dhash_from_gray(image)
+
+def compute_dhash_decoded(image):
+    """dHash для вже декодованого BGR зображення"""
+    if image is None:
+        return None
+    return dhash_from_gray(cv2.cvtColor(image, cv2.COLOR_BGR2GRAY))
+
+def dhash_from_gray(image):
+    small = cv2.resize(image, (9, 8), interpolation=cv2.INTER_AREA)
+    bits = small[:, 1:] > small[:, :-1]
+
+    value = 0
+    for bit in bits.flatten():
+        value = (value << 1) | int(bit)
+    # BIGINT знаковий: старший біт переносимо у знак
+    return value - (1 << 64) if value >= (1 << 63) else value
+
 def apply_white_blue_effect(image):
     # Конвертуємо у float для обробки
     result = image.astype(np.float32) / 255.0
@@ -0,0 +1,59 @@
+import threading
+from config import WORKER_CONFIG
+from database import extend_leases
+
+
+class LeaseKeeper:
+    """Heartbeat для завдань, які зараз обробляються: фоновий потік продовжує їх оренду.
+    Якщо обробник зупиниться, оренда спливе і завдання візьме інший обробник"""
+
+    def __init__(self):
+        self.worker_id = WORKER_CONFIG['worker_id']
+        self.task_ids = set()
+        self.lost = set()
+        self.lock = threading.Lock()
+        self.stopping = threading.Event()
+        self.thread = None
+
+    def start(self):
+        if self.thread is None:
+            self.thread = threading.Thread(target=self._loop, daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        self.stopping.set()
+        if self.thread is not None:
+            self.thread.join()
+            self.thread = None
+
+    def hold(self, task_id):
+        with self.lock:
+            self.task_ids.add(task_id)
+            self.lost.discard(task_id)
+
+    def release(self, task_id):
+        with self.lock:
+            self.task_ids.discard(task_id)
+
+    def is_lost(self, task_id):
+        """Оренду перехопив інший обробник (heartbeat не встиг продовжити її вчасно)"""
+        with self.lock:
+            return task_id in self.lost
+
+    def _loop(self):
+        while not self.stopping.wait(WORKER_CONFIG['heartbeat_seconds']):
+            with self.lock:
+                task_ids = set(self.task_ids)
+            if not task_ids:
+                continue
+            try:
+                held = extend_leases(task_ids, self.worker_id, WORKER_CONFIG['lease_seconds'])
+            except Exception as e:
+                # Наступна спроба через heartbeat_seconds, оренда ще не спливла
+                print(f"Не вдалося продовжити оренду завдань: {e}")
+                continue
+            with self.lock:
+                for task_id in task_ids - held:
+                    if task_id in self.task_ids and task_id not in self.lost:
+                        print(f"Оренду завдання {task_id} втрачено")
+                        self.lost.add(task_id)
@@ -1,112 +1,207 @@
 import time
 import os
-from database import get_processing_tasks, update_task_status
+import atexit
+import shutil
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from database import claim_task, complete_task, release_failed_task, bury_exhausted_tasks, find_cached_result
+from database import set_image_phash, get_images_without_phash
 from r2_storage import download_from_r2, upload_to_r2
-from image_processor import process_image, cleanup_files
+from image_processor import decode_image, process_decoded, format_from_path
+from image_processor import cleanup_files, detect_extension, compute_dhash, compute_dhash_decoded
 from database import get_pending_tasks
+from scheduler import Scheduler
+from lease import LeaseKeeper
+from config import SCHEDULER_CONFIG, PHASH_CONFIG, WORKER_CONFIG
 
-def process_single_task(task):
+scheduler = Scheduler()
+leases = LeaseKeeper()
+worker_id = WORKER_CONFIG['worker_id']
+# Тимчасові файли лише цього процесу: кілька обробників на одному хості
+# не перетинаються, а файли попередніх запусків ніколи не читаються
+work_dir = tempfile.mkdtemp(prefix="image-worker-")
+atexit.register(shutil.rmtree, work_dir, True)
+
+def process_image_group(tasks):
+    """Обробка взятих завдань одного зображення: оригінал завантажується і
+    декодується один раз, обробки, кодування та завантаження в R2 - паралельно"""
+    image_id = tasks[0]['image_id']
+    filename = tasks[0]['filename']
+
+    print(f"\n=== Обробка зображення {image_id}: завдання {[t['task_id'] for t in tasks]} ===")
+
+    # Ідентичне завдання могло завершитися, поки це чекало в черзі
+    remaining = []
+    for task in tasks:
+        cached_path = find_cached_result(task['task_id'])
+        if cached_path:
+            print(f"Завдання {task['task_id']}: знайдено готовий результат {cached_path}, обробка не потрібна")
+            complete_task(task['task_id'], worker_id, cached_path)
+        else:
+            remaining.append(task)
+    if not remaining:
+        return
+
+    # Спільний для всіх завдань зображення; розширення оригіналу зберігається
+    temp_input = os.path.join(work_dir, f"input_{image_id}{os.path.splitext(filename)[1]}")
+
+    try:
+        if not download_from_r2(f"original/{image_id}-{filename}", temp_input):
+            fail_tasks(remaining, "Помилка завантаження")
+            return
+
+        image = decode_image(temp_input)
+        if image is None:
+            fail_tasks(remaining, "Помилка декодування")
+            return
+
+        # Оригінал уже декодовано - заодно обчислюємо перцептивний хеш
+        if any(task.get('needs_phash') for task in remaining):
+            set_image_phash(image_id, compute_dhash_decoded(image))
+
+        default_format = format_from_path(filename)
+        threads = min(len(remaining), WORKER_CONFIG['fanout_threads'])
+        with ThreadPoolExecutor(max_workers=threads) as pool:
+            list(pool.map(lambda task: process_task_output(task, image, default_format), remaining))
+
+    finally:
+        cleanup_files([temp_input])
+
+def process_task_output(task, image, default_format):
+    """Обробка, кодування і завантаження результату одного завдання.
+    image спільний для всіх потоків і не змінюється"""
     task_id = task['task_id']
     image_id = task['image_id']
     filename = task['filename']
     processing_type = task['processing_type']
-    
-    print(f"\n=== Обробка завдання {task_id} ===")
-    
-    # Тимчасові файли для збереження
-    temp_input = f"temp_input_{task_id}_{filename}"
-    temp_output = f"temp_output_{task_id}_{filename}"
-    
-    # Шляхи в R2
-    r2_input_path = f"original/{image_id}-{filename}"
+    output_options = task.get('output_options') or ""
+
+    print(f"Завдання {task_id}: {processing_type} (спроба {task.get('attempts', 0) + 1})")
+    # trace id запиту, який створив завдання (для пошуку в трасах API)
+    if task.get('trace_id'):
+        print(f"trace_id={task['trace_id']}")
+
     r2_output_path = f"processed/{task_id}-{filename}"
-    
+    stem, original_ext = os.path.splitext(filename)
+    # Без параметрів кодування формат результату визначає розширення файлу
+    temp_output = os.path.join(work_dir, f"output_{task_id}{original_ext}")
+
     try:
-        # Визначаємо з якого кроку продовжити
-        current_step = determine_current_step(task_id, temp_input, temp_output)
-        
-        if current_step == "download":
-            print(f" Продовження завдання {task_id} з кроку завантаження")
-            # Крок 2: Завантаження з R2
-            if not download_from_r2(r2_input_path, temp_input):
-                raise Exception("Помилка завантаження")
-            current_step = "process"
-        
-        if current_step == "process":
-            print(f" Продовження завдання {task_id} з кроку обробки")
-            # Крок 3: Обробка зображення
-            if not process_image(temp_input, temp_output, processing_type):
-                raise Exception("Помилка обробки")
-            current_step = "upload"
-        
-        if current_step == "upload":
-            print(f"Продовження завдання {task_id} з кроку завантаження")
-            # Крок 4: Завантаження в R2 у папку processed
-            if not upload_to_r2(temp_output, r2_output_path):
-                raise Exception("Помилка завантаження")
-        
-        # Крок 5: Оновлення статусу в базі даних на "completed"
-        update_task_status(task_id, "completed", r2_output_path)
-        
+        if not process_decoded(image, temp_output, processing_type, output_options, default_format):
+            raise Exception("Помилка обробки")
+
+        # Оренду перехопили - результат запише інший обробник
+        if leases.is_lost(task_id):
+            raise Exception("Оренду завдання втрачено")
+
+        # Формат результату міг змінитися через output_options - розширення за вмістом
+        output_ext = detect_extension(temp_output, original_ext)
+        if output_ext.lower() != original_ext.lower():
+            r2_output_path = f"processed/{task_id}-{stem}{output_ext}"
+        if not upload_to_r2(temp_output, r2_output_path):
+            raise Exception("Помилка завантаження")
+
+        # Оновлення статусу в базі даних на "completed" (лише власником оренди)
+        if not complete_task(task_id, worker_id, r2_output_path):
+            return False
+
         print(f"Завдання {task_id} успішно завершено!")
         return True
-        
+
     except Exception as e:
         print(f"Завдання {task_id} невдале: {e}")
-        update_task_status(task_id, "failed")
+        # Повтор іншою спробою, після max_attempts - статус dead
+        release_failed_task(task_id, worker_id, WORKER_CONFIG['max_attempts'])
         return False
-        
+
     finally:
-        # Очищення тимчасових файлів тільки якщо завдання завершено або невдале
-        if not os.path.exists(temp_input) and not os.path.exists(temp_output):
-            cleanup_files([temp_input, temp_output])
-
-def determine_current_step(task_id, temp_input_path, temp_output_path):
-    # Перевіряємо чи вихідний файл вже існує (завантаження було в процесі)
-    if os.path.exists(temp_output_path):
-        print(f"Вихідний файл існує, продовження з кроку завантаження")
-        return "upload"
-    
-    # Перевіряємо чи вхідний файл існує (обробка була в процесі)
-    elif os.path.exists(temp_input_path):
-        print(f"Вхідний файл існує, продовження з кроку обробки")
-        return "process"
-    
-    # Інакше починаємо з завантаження
-    else:
-        print(f"Тимчасових файлів не знайдено, починаємо з кроку завантаження")
-        return "download"
+        cleanup_files([temp_output])
+
+def fail_tasks(tasks, reason):
+    for task in tasks:
+        print(f"Завдання {task['task_id']} невдале: {reason}")
+        release_failed_task(task['task_id'], worker_id, WORKER_CONFIG['max_attempts'])
+
+def claim_image_group(ordered_tasks):
+    """Бере перше за розкладом вільне завдання разом з іншими кандидатами
+    того ж зображення (до max_group_size), щоб оригінал декодувати один раз"""
+    lease_seconds = WORKER_CONFIG['lease_seconds']
+    max_attempts = WORKER_CONFIG['max_attempts']
+
+    for index, candidate in enumerate(ordered_tasks):
+        if not claim_task(candidate['task_id'], worker_id, lease_seconds, max_attempts):
+            continue
+
+        group = [candidate]
+        for other in ordered_tasks[index + 1:]:
+            if len(group) >= WORKER_CONFIG['max_group_size']:
+                break
+            if other['image_id'] == candidate['image_id'] and \
+                    claim_task(other['task_id'], worker_id, lease_seconds, max_attempts):
+                group.append(other)
+        return group
+
+    return []
 
 def process_pending_tasks():
-    pending_tasks = get_pending_tasks()
-    
-    for task in pending_tasks:
-        task_id = task['task_id']
-        
-        # Спочатку оновлюємо статус на "processing"
-        update_task_status(task_id, "processing")
-        
-        # Потім обробляємо з тією ж функцією
-        process_single_task(task)
+    # Після кожного зображення черга перечитується, щоб нові дешеві або
+    # пріоритетні завдання не чекали завершення всієї пачки
+    while True:
+        pending_tasks = get_pending_tasks(SCHEDULER_CONFIG['batch_size'], WORKER_CONFIG['max_attempts'])
+        group = claim_image_group(scheduler.order(pending_tasks))
+        if not group:
+            return
+
+        for task in group:
+            leases.hold(task['task_id'])
+        try:
+            process_image_group(group)
+        finally:
+            for task in group:
+                leases.release(task['task_id'])
+
+# image_id -> (кількість невдалих завантажень, час наступної спроби). Збій R2 може
+# бути тимчасовим, тож хеш не позначається як неможливий, а відкладається
+phash_retries = {}
+
+def hash_pending_images():
+    """Перцептивні хеші для зображень, які ще не проходили обробку"""
+    now = time.time()
+    waiting = [image_id for image_id, (_, retry_at) in phash_retries.items() if retry_at > now]
+    for image in get_images_without_phash(PHASH_CONFIG['batch_size'], waiting):
+        image_id = image['image_id']
+        filename = image['filename']
+        temp_path = os.path.join(work_dir, f"phash_{image_id}{os.path.splitext(filename)[1]}")
+        try:
+            if not download_from_r2(f"original/{image_id}-{filename}", temp_path):
+                # Інакше ті самі оригінали першими в ORDER BY id займали б усю пачку
+                failures = phash_retries.get(image_id, (0, 0))[0] + 1
+                delay = min(PHASH_CONFIG['retry_seconds'] * 2 ** (failures - 1), PHASH_CONFIG['max_retry_seconds'])
+                phash_retries[image_id] = (failures, time.time() + delay)
+                print(f"Не вдалося завантажити оригінал {image_id} для хешу, повтор через {delay} с")
+                continue
+            phash_retries.pop(image_id, None)
+            phash = compute_dhash(temp_path)
+            if phash is None:
+                print(f"Не вдалося декодувати зображення {image_id} для хешу")
+            set_image_phash(image_id, phash)
+        finally:
+            cleanup_files([temp_path])
 
 if __name__ == "__main__":
-    # Створюємо тимчасову директорію якщо потрібно
-    if not os.path.exists('temp'):
-        os.makedirs('temp')
-    
-    print("Запуск Python обробника")
+    print(f"Запуск Python обробника {worker_id}, тимчасові файли у {work_dir}")
+    leases.start()
     while True:
         
-        # Крок 1: Спочатку відновлюємо будь-які "застряглі" завдання в обробці
-        processing_tasks = get_processing_tasks()
+        # Крок 1: Завдання з простроченою орендою після останньої спроби - dead.
+        # Решта прострочених повертаються через get_pending_tasks
+        bury_exhausted_tasks(WORKER_CONFIG['max_attempts'])
         
-        if processing_tasks:
-            print(f"Знайдено {len(processing_tasks)} завдань в статусі обробки. Відновлення...")
-            for task in processing_tasks:
-                process_single_task(task)
-        
-        # Крок 2: Потім обробляємо нові завдання в очікуванні
+        # Крок 2: Обробляємо завдання в очікуванні та з простроченою орендою
         process_pending_tasks()
+
+        # Крок 3: Хеші для пошуку схожих зображень
+        hash_pending_images()
         
         # Чекаємо перед наступною ітерацією
         print("Немає завдань для обробки. Очікування 10 секунд")
@@ -1,3 +1,4 @@
+import os
 import boto3
 from botocore.config import Config
 from config import R2_CONFIG
@@ -21,10 +22,23 @@ def download_from_r2(r2_path, local_path):
         print(f"Помилка завантаження {r2_path}: {e}")
         return False
 
+CONTENT_TYPES = {
+    '.jpg': 'image/jpeg',
+    '.jpeg': 'image/jpeg',
+    '.png': 'image/png',
+    '.webp': 'image/webp',
+    '.gif': 'image/gif',
+    '.bmp': 'image/bmp',
+}
+
 def upload_to_r2(local_path, r2_path):
     """Завантажити файл в R2"""
     try:
-        r2_client.upload_file(local_path, R2_CONFIG['bucket_name'], r2_path)
+        extra_args = {}
+        content_type = CONTENT_TYPES.get(os.path.splitext(r2_path)[1].lower())
+        if content_type:
+            extra_args['ContentType'] = content_type
+        r2_client.upload_file(local_path, R2_CONFIG['bucket_name'], r2_path, ExtraArgs=extra_args)
         print(f"Завантажено: {r2_path}")
         return True
     except Exception as e:
@@ -0,0 +1,84 @@
+import time
+from config import SCHEDULER_CONFIG
+from database import get_cost_statistics
+
+# Початкові оцінки тривалості (секунди на 1 МБ вхідного файлу),
+# поки немає історії виконаних завдань
+DEFAULT_COST = {
+    "white-blue": 0.6,
+    "grayscale": 0.2,
+    "blur": 1.5,
+    "sharpen": 0.8,
+    "edge-detection": 0.7,
+    "sepia": 0.5,
+    "invert": 0.1,
+    "brightness": 0.5,
+    "contrast": 0.3,
+}
+DEFAULT_BYTES = 1024 * 1024
+
+
+class CostModel:
+    """Оцінка тривалості завдання: intercept + slope * розмір файлу для кожного типу обробки.
+    Коефіцієнти підбираються регресією по колонці тривалості виконаних завдань"""
+
+    def __init__(self):
+        self.coefficients = {}
+        self.refreshed_at = 0
+
+    def refresh(self):
+        if time.time() - self.refreshed_at < SCHEDULER_CONFIG['cost_refresh_seconds']:
+            return
+        try:
+            self.coefficients = get_cost_statistics(SCHEDULER_CONFIG['cost_history_days'])
+        except Exception as e:
+            print(f"Не вдалося оновити модель вартості: {e}")
+        self.refreshed_at = time.time()
+
+    def estimate(self, processing_type, size_bytes):
+        size_bytes = size_bytes or DEFAULT_BYTES
+        stats = self.coefficients.get(processing_type)
+
+        if stats:
+            intercept, slope, avg_seconds = stats
+            if slope is not None and intercept is not None:
+                estimate = intercept + slope * size_bytes
+                if estimate > 0:
+                    return estimate
+            if avg_seconds:
+                return avg_seconds
+
+        return DEFAULT_COST.get(processing_type, 1.0) * size_bytes / DEFAULT_BYTES
+
+
+class Scheduler:
+    """Порядок обробки: пріоритет типу та завдання, найкоротше завдання першим,
+    старіння очікування. Завдання, що чекають довше max_wait_seconds, йдуть першими"""
+
+    def __init__(self, cost_model=None):
+        self.cost_model = cost_model or CostModel()
+
+    def score(self, task):
+        priority = SCHEDULER_CONFIG['type_priority'].get(task['processing_type'], 0) + (task.get('priority') or 0)
+        estimate = self.cost_model.estimate(task['processing_type'], task.get('size_bytes'))
+        age = task.get('age_seconds') or 0
+
+        # Вищий пріоритет зменшує ефективну вартість, очікування поступово її зменшує
+        weight = 2 ** (priority / 2)
+        return estimate / weight - SCHEDULER_CONFIG['aging_rate'] * age
+
+    def order(self, tasks):
+        self.cost_model.refresh()
+        max_wait = SCHEDULER_CONFIG['max_wait_seconds']
+
+        starving = [t for t in tasks if (t.get('age_seconds') or 0) >= max_wait]
+        regular = [t for t in tasks if (t.get('age_seconds') or 0) < max_wait]
+
+        # Гарантія від голодування: найстаріші завдання без урахування вартості
+        starving.sort(key=lambda t: -(t.get('age_seconds') or 0))
+        regular.sort(key=self.score)
+        return starving + regular
+
+    def next_task(self, tasks):
+        ordered = self.order(tasks)
+        return ordered[0] if ordered else None
@@ -67,6 +67,10 @@ const ImageDetail = ({ image, onBack, onProcessingComplete }) => {
   };
 
   // Отримання читабельної назви типу обробки
+  // Результат з кешу може лежати під ключем іншого завдання
+  const getProcessedUrl = (task) =>
+    task.processed_url || `https://senchuknazar123.online/processed/${task.id}-${image.filename}`;
+
   const getProcessingTypeLabel = (processingType) => {
     const type = processingTypes.find(pt => pt.value === processingType);
     return type ? type.label : processingType;
@@ -257,19 +261,19 @@ const ImageDetail = ({ image, onBack, onProcessingComplete }) => {
                           <div style={styles.completedTask}>
                             <div style={styles.processedImageSection}>
                               <img
-                                src={`https://senchuknazar123.online/processed/${task.id}-${image.filename}`}
+                                src={getProcessedUrl(task)}
                                 alt={`Processed: ${task.processing_type}`}
                                 style={styles.processedThumbnail}
                               />
                               <div style={styles.processedActions}>
                                 <button
-                                  onClick={() => window.open(`https://senchuknazar123.online/processed/${task.id}-${image.filename}`, '_blank')}
+                                  onClick={() => window.open(getProcessedUrl(task), '_blank')}
                                   style={styles.viewButton}
                                 >
                                   👀 Переглянути
                                 </button>
                                 <button
-                                  onClick={() => downloadImage(`https://senchuknazar123.online/processed/${task.id}-${image.filename}`, `${task.id}-${image.filename}`)}
+                                  onClick={() => downloadImage(getProcessedUrl(task), `${task.id}-${image.filename}`)}
                                   style={styles.downloadButton}
                                 >
                                   💾 Завантажити
@@ -40,8 +40,26 @@ class PhotoApi {
   static getImages = () => this.request('/images');
   
   static getImageById = (imageId) => this.request(`/images/${imageId}`);
+
+  // Схожі зображення за перцептивним хешем: [{ id, distance }]
+  static getSimilarImages = async (imageId, maxDistance = 8) => {
+    const response = await this.request(`/images/${imageId}/similar`, { params: { max_distance: maxDistance } });
+    return response.similar || [];
+  };
+
+  // Кілька зображень одним запитом
+  static getImagesByIds = async (imageIds) => {
+    if (!imageIds.length) return [];
+    const response = await this.request('/images', { params: { ids: imageIds.join(',') } });
+    return response.images || [];
+  };
   
-  static uploadImage = (file, name, description = '') => {
+  static uploadImage = (file, name, description = '', onProgress = null) => {
+    // Великі файли завантажуються частинами з можливістю відновлення
+    if (file.size > this.RESUMABLE_THRESHOLD) {
+      return this.uploadImageResumable(file, name, description, onProgress);
+    }
+
     const formData = new FormData();
     formData.append('file', file);
     formData.append('name', name);
@@ -55,12 +73,77 @@ class PhotoApi {
     });
   };
 
+  static RESUMABLE_THRESHOLD = 8 * 1024 * 1024;
+  static MAX_CHUNK_RETRIES = 5;
+
+  // Відновлюване завантаження: сесія, PATCH частин за зміщенням, завершення.
+  // Після обриву з'єднання продовжуємо з підтвердженого сервером зміщення
+  static uploadImageResumable = async (file, name, description = '', onProgress = null) => {
+    const formData = new FormData();
+    formData.append('name', name);
+    formData.append('description', description);
+    formData.append('filename', file.name);
+    formData.append('size', file.size.toString());
+
+    const session = await this.request('/uploads', {
+      method: 'POST',
+      data: formData,
+      headers: { 'Content-Type': 'multipart/form-data' },
+    });
+
+    let offset = session.upload_offset;
+    let retries = 0;
+
+    while (offset < file.size) {
+      const chunk = file.slice(offset, Math.min(offset + session.part_size, file.size));
+      try {
+        const response = await axios({
+          baseURL: this.baseURL,
+          url: `/uploads/${session.id}`,
+          method: 'PATCH',
+          data: chunk,
+          timeout: 60000,
+          headers: {
+            'Content-Type': 'application/offset+octet-stream',
+            'Upload-Offset': offset.toString(),
+            'Tus-Resumable': '1.0.0',
+          },
+        });
+        offset = parseInt(response.headers['upload-offset'], 10);
+        retries = 0;
+        if (onProgress) onProgress(offset / file.size);
+      } catch (error) {
+        if (++retries > this.MAX_CHUNK_RETRIES) {
+          this.handleError(error);
+          throw error;
+        }
+        // Пауза з експоненційним зростанням, потім уточнюємо зміщення на сервері
+        await new Promise(resolve => setTimeout(resolve, 1000 * 2 ** (retries - 1)));
+        try {
+          const state = await this.request(`/uploads/${session.id}`);
+          offset = state.upload_offset;
+        } catch {
+          // сервер недоступний - повторимо з тим самим зміщенням
+        }
+      }
+    }
+
+    const result = await this.request(`/uploads/${session.id}/complete`, { method: 'POST' });
+    return { ...result, id: session.image_id, name, description, filename: file.name };
+  };
+
   //  Методи для тасків
-  static getTasks = async (imageId = null) => {
-    const endpoint = imageId ? `/tasks/${imageId}` : '/tasks';
-    const response = await this.request(endpoint);
+  static getTasks = async (imageId) => {
+    const response = await this.request(`/tasks/${imageId}`);
     return response.tasks || [];
   };
+
+  // Завдання для сторінки зображень одним запитом: { [imageId]: [tasks] }
+  static getTasksForImages = async (imageIds) => {
+    if (!imageIds.length) return {};
+    const response = await this.request('/tasks', { params: { image_ids: imageIds.join(',') } });
+    return response.tasks || {};
+  };
   
   static createTask = (imageId, processingType) => {
     const formData = new FormData();